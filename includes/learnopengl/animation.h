@@ -7,9 +7,13 @@
 #include <assimp/Importer.hpp>
 #include <functional>
 #include <algorithm>
+#include <cstring>
+#include <iostream>
 #include <string>
 
-#include <learnopengl/bone.h>
+#include <learnopengl/animation_tracks.h>
+#include <learnopengl/baked_cache.h>
+#include <learnopengl/import_cache.h>
 #include <learnopengl/model.h>
 #include <learnopengl/assimp_glm_helpers.h>
 
@@ -21,65 +25,222 @@ struct AssimpNodeData
     std::vector<AssimpNodeData> children;
 };
 
+// AssimpNodeData flattened in depth-first order, so a node's parent always comes before it
+// and the whole skeleton can be evaluated in one linear pass.
+struct SkeletonNode
+{
+    glm::mat4 transformation; // bind pose local transform, used when the clip does not animate the node
+    glm::mat4 offset;         // bone offset matrix, identity for nodes that are not bones
+    int parent;               // index into the node array, -1 for the root
+    int channel;              // index into the clip's AnimationTracks channels, -1 if not animated
+    int boneIndex;            // slot in the final bone matrices, -1 if the node is not a bone
+    int depth;                // distance from the root, used to pick bone subsets for LOD
+};
+
 class Animation
 {
 public:
     Animation() = default;
 
-    Animation(const std::string& animationPath, Model* model)
+    // resampleRate (samples per second) > 0 bakes every channel onto a uniform grid so sampling
+    // is a direct lookup; 0 keeps the source keys, sampled through per-animator KeyCursors
+    // the imported (and resampled) clip is baked next to the source file and reused on later runs
+    Animation(const std::string& animationPath, Model* model, float resampleRate = 0.0f)
     {
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(animationPath, aiProcess_Triangulate);
+        if (LoadBaked(animationPath, *model, resampleRate))
+            return;
+
+        // reuses the model's scene when the clip lives in the model file, otherwise imports
+        // without meshes
+        ImportCache::Scene imported = ImportCache::Shared().Get(animationPath, ImportCache::ANIMATION_ONLY);
+        const aiScene* scene = imported.scene;
         assert(scene && scene->mRootNode);
         auto animation = scene->mAnimations[0];
         m_Duration = animation->mDuration;
         m_TicksPerSecond = animation->mTicksPerSecond;
         ReadHierarchyData(m_RootNode, scene->mRootNode);
         ReadMissingBones(animation, *model);
+        FlattenHierarchy(m_RootNode, -1);
+        if (resampleRate > 0.0f)
+        {
+            float ticksPerSecond = m_TicksPerSecond > 0 ? (float)m_TicksPerSecond : 25.0f;
+            m_Tracks.Resample(resampleRate / ticksPerSecond, m_Duration);
+        }
+        if (!SaveBaked(animationPath, resampleRate))
+            std::cout << "ERROR::ANIMATION::BAKE failed to write cache for " << animationPath << std::endl;
     }
 
     ~Animation() {}
 
-    Bone* FindBone(const std::string& name)
+    // channel index for a node name, -1 if the clip does not animate it
+    int FindChannel(const std::string& name) const
     {
-        auto iter = std::find_if(m_Bones.begin(), m_Bones.end(),
-            [&](const Bone& Bone)
-            {
-                return Bone.GetBoneName() == name;
-            }
-        );
-        if (iter == m_Bones.end()) return nullptr;
-        else return &(*iter);
+        auto iter = std::find(m_ChannelNames.begin(), m_ChannelNames.end(), name);
+        if (iter == m_ChannelNames.end()) return -1;
+        else return (int)(iter - m_ChannelNames.begin());
+    }
+
+    // compresses the channel data (see AnimationTracks::Compress) and releases what evaluation no
+    // longer needs: the node tree, this clip's copy of the bone info map and the channel names.
+    // GetRootNode, GetBoneIDMap and FindChannel return nothing useful afterwards.
+    // the report's byte counts cover the whole clip, not only the tracks.
+    CompressionReport Compress(const AnimationCompression& settings = AnimationCompression())
+    {
+        size_t before = ByteSize();
+        CompressionReport report = m_Tracks.Compress(settings);
+        m_RootNode = AssimpNodeData();
+        m_RootNode.childrenCount = 0;
+        m_BoneInfoMap.clear();
+        std::vector<std::string>().swap(m_ChannelNames);
+        m_Nodes.shrink_to_fit();
+        report.bytesBefore = before;
+        report.bytesAfter = ByteSize();
+        return report;
+    }
+
+    // approximate heap + object footprint of the clip
+    size_t ByteSize() const
+    {
+        size_t bytes = sizeof(Animation) + m_Tracks.ByteSize() + m_Nodes.capacity() * sizeof(SkeletonNode);
+        for (const std::string& name : m_ChannelNames)
+            bytes += sizeof(std::string) + name.capacity();
+        for (const auto& entry : m_BoneInfoMap)
+            bytes += sizeof(entry) + entry.first.capacity();
+        return bytes + TreeByteSize(m_RootNode);
     }
 
     inline float GetTicksPerSecond() { return m_TicksPerSecond; }
     inline float GetDuration() { return m_Duration;}
     inline const AssimpNodeData& GetRootNode() { return m_RootNode; }
     inline const std::map<std::string,BoneInfo>& GetBoneIDMap() { return m_BoneInfoMap; }
+    inline const std::vector<SkeletonNode>& GetNodes() const { return m_Nodes; }
+    inline const AnimationTracks& GetTracks() const { return m_Tracks; }
+    inline int GetChannelCount() const { return (int)m_Tracks.channels.size(); }
 
 private:
     void ReadMissingBones(const aiAnimation* animation, Model& model)
     {
         int size = animation->mNumChannels;
-        auto& boneInfoMap = model.GetBoneInfoMap();
-        int& boneCount = model.GetBoneCount();
-
         for (int i = 0; i < size; i++)
         {
             auto channel = animation->mChannels[i];
-            std::string boneName = channel->mNodeName.data;
+            m_ChannelNames.push_back(channel->mNodeName.data);
+            m_Tracks.AddChannel(channel);
+        }
+        RegisterChannelBones(model);
+    }
 
+    // channels animating nodes the model has no bone for get a new bone id in the model
+    void RegisterChannelBones(Model& model)
+    {
+        auto& boneInfoMap = model.GetBoneInfoMap();
+        int& boneCount = model.GetBoneCount();
+        for (const std::string& boneName : m_ChannelNames)
+        {
             if (boneInfoMap.find(boneName) == boneInfoMap.end())
             {
                 boneInfoMap[boneName].id = boneCount;
                 boneCount++;
             }
-            m_Bones.push_back(Bone(channel->mNodeName.data,
-                boneInfoMap[channel->mNodeName.data].id, channel));
         }
         m_BoneInfoMap = boneInfoMap;
     }
 
+    // the bake holds only what comes from the file: timing, channel names, tracks and the node
+    // tree. bone ids depend on the model (and on which clips were loaded before), so they are
+    // resolved again on load exactly like after an import.
+    bool SaveBaked(const std::string& path, float resampleRate)
+    {
+        BakedCache::Writer writer(path, BakedCache::ANIMATION, BakeParameters(resampleRate));
+        writer.Write(m_Duration);
+        writer.Write((int32_t)m_TicksPerSecond);
+        writer.Write((uint32_t)m_ChannelNames.size());
+        for (const std::string& name : m_ChannelNames)
+            writer.WriteString(name);
+        writer.WriteVector(m_Tracks.channels);
+        writer.WriteVector(m_Tracks.positionTimes);
+        writer.WriteVector(m_Tracks.positions);
+        writer.WriteVector(m_Tracks.rotationTimes);
+        writer.WriteVector(m_Tracks.rotations);
+        writer.WriteVector(m_Tracks.scaleTimes);
+        writer.WriteVector(m_Tracks.scales);
+        writer.Write(m_Tracks.sampleRate);
+        WriteNode(writer, m_RootNode);
+        return writer.Commit();
+    }
+
+    bool LoadBaked(const std::string& path, Model& model, float resampleRate)
+    {
+        BakedCache::Reader reader(path, BakedCache::ANIMATION, BakeParameters(resampleRate));
+        if (!reader.Valid())
+            return false;
+
+        int32_t ticksPerSecond = 0;
+        uint32_t channelCount = 0;
+        reader.Read(m_Duration);
+        reader.Read(ticksPerSecond);
+        reader.Read(channelCount);
+        for (uint32_t i = 0; i < channelCount && reader.Valid(); i++)
+        {
+            std::string name;
+            reader.ReadString(name);
+            m_ChannelNames.push_back(name);
+        }
+        reader.ReadVector(m_Tracks.channels);
+        reader.ReadVector(m_Tracks.positionTimes);
+        reader.ReadVector(m_Tracks.positions);
+        reader.ReadVector(m_Tracks.rotationTimes);
+        reader.ReadVector(m_Tracks.rotations);
+        reader.ReadVector(m_Tracks.scaleTimes);
+        reader.ReadVector(m_Tracks.scales);
+        reader.Read(m_Tracks.sampleRate);
+        bool ok = ReadNode(reader, m_RootNode) && m_Tracks.channels.size() == m_ChannelNames.size();
+        if (!ok)
+        {
+            std::cout << "ERROR::ANIMATION::BAKE corrupt cache for " << path << ", reimporting" << std::endl;
+            m_ChannelNames.clear();
+            m_Tracks = AnimationTracks();
+            m_RootNode = AssimpNodeData();
+            return false;
+        }
+        m_TicksPerSecond = ticksPerSecond;
+        RegisterChannelBones(model);
+        FlattenHierarchy(m_RootNode, -1);
+        return true;
+    }
+
+    static uint64_t BakeParameters(float resampleRate)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &resampleRate, sizeof(bits));
+        return bits;
+    }
+
+    static void WriteNode(BakedCache::Writer& writer, const AssimpNodeData& node)
+    {
+        writer.WriteString(node.name);
+        writer.Write(node.transformation);
+        writer.Write((int32_t)node.childrenCount);
+        for (int i = 0; i < node.childrenCount; i++)
+            WriteNode(writer, node.children[i]);
+    }
+
+    static bool ReadNode(BakedCache::Reader& reader, AssimpNodeData& node, int depth = 0)
+    {
+        int32_t childrenCount = 0;
+        reader.ReadString(node.name);
+        reader.Read(node.transformation);
+        // a corrupt count must not recurse without bound
+        if (!reader.Read(childrenCount) || childrenCount < 0 || childrenCount > 65536 || depth > 1024)
+            return false;
+        node.childrenCount = childrenCount;
+        node.children.resize(childrenCount);
+        for (int i = 0; i < childrenCount; i++)
+            if (!ReadNode(reader, node.children[i], depth + 1))
+                return false;
+        return reader.Valid();
+    }
+
     void ReadHierarchyData(AssimpNodeData& dest, const aiNode* src)
     {
         assert(src);
@@ -95,9 +256,42 @@ private:
         }
     }
 
+    static size_t TreeByteSize(const AssimpNodeData& node)
+    {
+        size_t bytes = node.name.capacity();
+        for (const AssimpNodeData& child : node.children)
+            bytes += sizeof(AssimpNodeData) + TreeByteSize(child);
+        return bytes;
+    }
+
+    // resolves channel and bone lookups once so evaluation never searches by name
+    void FlattenHierarchy(const AssimpNodeData& src, int parent)
+    {
+        SkeletonNode node;
+        node.transformation = src.transformation;
+        node.offset = glm::mat4(1.0f);
+        node.parent = parent;
+        node.depth = parent >= 0 ? m_Nodes[parent].depth + 1 : 0;
+        node.channel = FindChannel(src.name);
+        node.boneIndex = -1;
+        auto info = m_BoneInfoMap.find(src.name);
+        if (info != m_BoneInfoMap.end())
+        {
+            node.boneIndex = info->second.id;
+            node.offset = info->second.offset;
+        }
+
+        int index = (int)m_Nodes.size();
+        m_Nodes.push_back(node);
+        for (int i = 0; i < src.childrenCount; i++)
+            FlattenHierarchy(src.children[i], index);
+    }
+
     float m_Duration;
     int m_TicksPerSecond;
-    std::vector<Bone> m_Bones;
+    AnimationTracks m_Tracks;
+    std::vector<std::string> m_ChannelNames;
     AssimpNodeData m_RootNode;
+    std::vector<SkeletonNode> m_Nodes;
     std::map<std::string, BoneInfo> m_BoneInfoMap;
 };
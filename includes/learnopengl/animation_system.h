@@ -0,0 +1,72 @@
+#ifndef ANIMATION_SYSTEM_H
+#define ANIMATION_SYSTEM_H
+
+#include <learnopengl/animator.h>
+#include <learnopengl/bone_palette.h>
+#include <learnopengl/thread_pool.h>
+
+#include <algorithm>
+#include <vector>
+
+// Updates every registered Animator once per frame, in parallel on the worker pool.
+// Each active character gets a slice of the frame's BonePalette reserved up front on the calling
+// thread; workers then evaluate their skeleton and copy the result straight into that slice, so
+// no two threads ever write the same memory. Update() blocks until all poses are done, which keeps
+// PlayAnimation() and rendering on the main thread free of synchronisation.
+class AnimationSystem
+{
+public:
+    struct Character
+    {
+        Animator* animator = nullptr;
+        int boneCount = 0;
+        bool active = true;
+        int paletteOffset = -1; // this frame's offset into the BonePalette, -1 if not evaluated
+    };
+
+    explicit AnimationSystem(ThreadPool& pool) : pool(pool) {}
+
+    // returns a handle for SetActive / GetPaletteOffset
+    int Add(Animator* animator, int boneCount)
+    {
+        Character character;
+        character.animator = animator;
+        character.boneCount = std::min(boneCount, (int)animator->GetFinalBoneMatrices().size());
+        characters.push_back(character);
+        return (int)characters.size() - 1;
+    }
+
+    // inactive characters are neither evaluated nor given a palette
+    void SetActive(int handle, bool active) { characters[handle].active = active; }
+
+    int GetPaletteOffset(int handle) const { return characters[handle].paletteOffset; }
+    int GetBoneCount(int handle) const { return characters[handle].boneCount; }
+
+    // starts a new palette frame, then evaluates and writes all active characters' palettes.
+    // the palette still has to be uploaded (on the GL thread) before drawing.
+    void Update(float dt, BonePalette& palette)
+    {
+        palette.Begin();
+        activeList.clear();
+        for (int i = 0; i < (int)characters.size(); i++)
+        {
+            Character& c = characters[i];
+            c.paletteOffset = c.active ? palette.Reserve(c.boneCount) : -1;
+            if (c.active) activeList.push_back(i);
+        }
+
+        pool.ParallelFor((int)activeList.size(), [&](int j)
+        {
+            Character& c = characters[activeList[j]];
+            c.animator->UpdateAnimation(dt);
+            const std::vector<glm::mat4>& matrices = c.animator->GetFinalBoneMatrices();
+            std::copy(matrices.begin(), matrices.begin() + c.boneCount, palette.Data(c.paletteOffset));
+        });
+    }
+
+private:
+    ThreadPool& pool;
+    std::vector<Character> characters;
+    std::vector<int> activeList;
+};
+#endif
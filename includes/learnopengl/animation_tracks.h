@@ -0,0 +1,463 @@
+#ifndef ANIMATION_TRACKS_H
+#define ANIMATION_TRACKS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <assimp/anim.h>
+
+#include <learnopengl/assimp_glm_helpers.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Per-animator search position inside one channel's key arrays. Playback time mostly moves
+// forward, so starting the key search here makes locating the surrounding keys O(1) amortized.
+struct KeyCursor
+{
+    int position = 0;
+    int rotation = 0;
+    int scale = 0;
+};
+
+// Tolerances for AnimationTracks::Compress, in model units for translation and scale and in
+// radians for rotation. Keys that interpolation reproduces within tolerance are removed.
+struct AnimationCompression
+{
+    float positionTolerance = 0.001f;
+    float rotationTolerance = 0.001f;
+    float scaleTolerance = 0.001f;
+};
+
+// What Compress() did to a clip. Errors are the largest deviation from the uncompressed clip
+// measured at every original key.
+struct CompressionReport
+{
+    size_t bytesBefore = 0;
+    size_t bytesAfter = 0;
+    int keysBefore = 0;
+    int keysAfter = 0;
+    int constantTracks = 0;
+    float maxPositionError = 0.0f;
+    float maxRotationError = 0.0f; // degrees
+    float maxScaleError = 0.0f;
+};
+
+// 16-bit fixed point vector, dequantized against a per-channel min and step
+struct PackedVec3
+{
+    uint16_t v[3];
+};
+
+// smallest-three quaternion: 2-bit index of the dropped largest component + 3 x 15 bits
+struct PackedQuat
+{
+    uint16_t v[3];
+};
+
+// All channels of one clip in contiguous structure-of-arrays storage: key times and key values
+// live in separate arrays and every channel owns a [first, first + count) range in them.
+// After Resample() the keys sit on a uniform grid, the time arrays are dropped and a sample is
+// a direct index computation. Times are in ticks, like Animator::m_CurrentTime.
+class AnimationTracks
+{
+public:
+    struct Range
+    {
+        int first = 0;
+        int count = 0;
+    };
+
+    struct Channel
+    {
+        Range position;
+        Range rotation;
+        Range scale;
+        // dequantization ranges, only used once the clip is compressed
+        glm::vec3 positionMin = glm::vec3(0.0f);
+        glm::vec3 positionStep = glm::vec3(0.0f);
+        glm::vec3 scaleMin = glm::vec3(0.0f);
+        glm::vec3 scaleStep = glm::vec3(0.0f);
+    };
+
+    std::vector<Channel> channels;
+    std::vector<float> positionTimes;
+    std::vector<glm::vec3> positions;
+    std::vector<float> rotationTimes;
+    std::vector<glm::quat> rotations;
+    std::vector<float> scaleTimes;
+    std::vector<glm::vec3> scales;
+
+    // compressed storage, replaces positions / rotations / scales after Compress()
+    std::vector<PackedVec3> packedPositions;
+    std::vector<PackedQuat> packedRotations;
+    std::vector<PackedVec3> packedScales;
+
+    // samples per tick, 0 while the clip still uses its source keys
+    float sampleRate = 0.0f;
+    bool compressed = false;
+
+    bool IsResampled() const { return sampleRate > 0.0f; }
+
+    size_t ByteSize() const
+    {
+        return channels.size() * sizeof(Channel)
+            + (positionTimes.size() + rotationTimes.size() + scaleTimes.size()) * sizeof(float)
+            + positions.size() * sizeof(glm::vec3) + rotations.size() * sizeof(glm::quat) + scales.size() * sizeof(glm::vec3)
+            + (packedPositions.size() + packedScales.size()) * sizeof(PackedVec3) + packedRotations.size() * sizeof(PackedQuat);
+    }
+
+    int KeyCount() const
+    {
+        int keys = 0;
+        for (const Channel& c : channels)
+            keys += c.position.count + c.rotation.count + c.scale.count;
+        return keys;
+    }
+
+    void AddChannel(const aiNodeAnim* channel)
+    {
+        Channel c;
+        c.position = { (int)positions.size(), (int)channel->mNumPositionKeys };
+        for (unsigned int i = 0; i < channel->mNumPositionKeys; i++)
+        {
+            positionTimes.push_back((float)channel->mPositionKeys[i].mTime);
+            positions.push_back(AssimpGLMHelpers::GetGLMVec(channel->mPositionKeys[i].mValue));
+        }
+        c.rotation = { (int)rotations.size(), (int)channel->mNumRotationKeys };
+        for (unsigned int i = 0; i < channel->mNumRotationKeys; i++)
+        {
+            rotationTimes.push_back((float)channel->mRotationKeys[i].mTime);
+            rotations.push_back(AssimpGLMHelpers::GetGLMQuat(channel->mRotationKeys[i].mValue));
+        }
+        c.scale = { (int)scales.size(), (int)channel->mNumScalingKeys };
+        for (unsigned int i = 0; i < channel->mNumScalingKeys; i++)
+        {
+            scaleTimes.push_back((float)channel->mScalingKeys[i].mTime);
+            scales.push_back(AssimpGLMHelpers::GetGLMVec(channel->mScalingKeys[i].mValue));
+        }
+        channels.push_back(c);
+    }
+
+    // rebuilds every animated channel as samples taken at least every 1 / ticksRate ticks over
+    // [0, duration]; the rate is nudged so the last sample lands exactly on 'duration'.
+    // single-key (constant) channels keep their one key.
+    void Resample(float ticksRate, float duration)
+    {
+        if (ticksRate <= 0.0f || duration <= 0.0f || IsResampled() || compressed) return;
+        int gridCount = (int)std::ceil(duration * ticksRate) + 1;
+        ticksRate = (gridCount - 1) / duration;
+
+        AnimationTracks out;
+        out.sampleRate = ticksRate;
+        for (int c = 0; c < (int)channels.size(); c++)
+        {
+            const Channel& src = channels[c];
+            KeyCursor cursor;
+            Channel dst;
+            int n = src.position.count > 1 ? gridCount : src.position.count;
+            dst.position = { (int)out.positions.size(), n };
+            for (int i = 0; i < n; i++)
+                out.positions.push_back(SamplePosition(src, std::min(i / ticksRate, duration), cursor));
+            n = src.rotation.count > 1 ? gridCount : src.rotation.count;
+            dst.rotation = { (int)out.rotations.size(), n };
+            for (int i = 0; i < n; i++)
+                out.rotations.push_back(SampleRotation(src, std::min(i / ticksRate, duration), cursor));
+            n = src.scale.count > 1 ? gridCount : src.scale.count;
+            dst.scale = { (int)out.scales.size(), n };
+            for (int i = 0; i < n; i++)
+                out.scales.push_back(SampleScale(src, std::min(i / ticksRate, duration), cursor));
+            out.channels.push_back(dst);
+        }
+        *this = std::move(out);
+    }
+
+    // local transform of a channel at 'time'; cursor is only read/updated for keyed tracks
+    glm::mat4 Sample(int channel, float time, KeyCursor& cursor) const
+    {
+        const Channel& c = channels[channel];
+        glm::mat4 translation = glm::translate(glm::mat4(1.0f), SamplePosition(c, time, cursor));
+        glm::mat4 rotation = glm::mat4_cast(SampleRotation(c, time, cursor));
+        glm::mat4 scale = glm::scale(glm::mat4(1.0f), SampleScale(c, time, cursor));
+        return translation * rotation * scale;
+    }
+
+    // a track without keys samples as the identity (no offset, no rotation, unit scale)
+    glm::vec3 SamplePosition(const Channel& c, float time, KeyCursor& cursor) const
+    {
+        if (c.position.count == 0) return glm::vec3(0.0f);
+        float t;
+        int i = Locate(c.position, positionTimes, time, cursor.position, t);
+        if (c.position.count == 1) return PositionKey(c, i);
+        return glm::mix(PositionKey(c, i), PositionKey(c, i + 1), t);
+    }
+
+    glm::quat SampleRotation(const Channel& c, float time, KeyCursor& cursor) const
+    {
+        if (c.rotation.count == 0) return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        float t;
+        int i = Locate(c.rotation, rotationTimes, time, cursor.rotation, t);
+        if (c.rotation.count == 1) return glm::normalize(RotationKey(i));
+        return glm::normalize(glm::slerp(RotationKey(i), RotationKey(i + 1), t));
+    }
+
+    glm::vec3 SampleScale(const Channel& c, float time, KeyCursor& cursor) const
+    {
+        if (c.scale.count == 0) return glm::vec3(1.0f);
+        float t;
+        int i = Locate(c.scale, scaleTimes, time, cursor.scale, t);
+        if (c.scale.count == 1) return ScaleKey(c, i);
+        return glm::mix(ScaleKey(c, i), ScaleKey(c, i + 1), t);
+    }
+
+    glm::vec3 PositionKey(const Channel& c, int i) const { return compressed ? Unpack(packedPositions[i], c.positionMin, c.positionStep) : positions[i]; }
+    glm::quat RotationKey(int i) const { return compressed ? Unpack(packedRotations[i]) : rotations[i]; }
+    glm::vec3 ScaleKey(const Channel& c, int i) const { return compressed ? Unpack(packedScales[i], c.scaleMin, c.scaleStep) : scales[i]; }
+
+    // collapses constant tracks, drops keys that interpolation reproduces within tolerance (keyed
+    // clips only, a resampled grid must stay uniform), then quantizes translations and scales to
+    // 16-bit fixed point and rotations to 48-bit smallest-three. Returns sizes and measured error.
+    CompressionReport Compress(const AnimationCompression& settings)
+    {
+        CompressionReport report;
+        if (compressed) return report;
+        report.bytesBefore = ByteSize();
+        report.keysBefore = KeyCount();
+
+        const AnimationTracks original = *this;
+        AnimationTracks out;
+        out.sampleRate = sampleRate;
+        std::vector<int> kept;
+
+        auto vecError = [](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); };
+        auto quatError = [](const glm::quat& a, const glm::quat& b) { return QuatAngle(a, b); };
+        auto vecLerp = [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); };
+        auto quatLerp = [](const glm::quat& a, const glm::quat& b, float t) { return glm::normalize(glm::slerp(a, b, t)); };
+
+        for (const Channel& src : channels)
+        {
+            Channel dst;
+
+            SelectKeys(src.position, positionTimes, positions, settings.positionTolerance, vecLerp, vecError, kept, report);
+            dst.position = { (int)out.packedPositions.size(), (int)kept.size() };
+            QuantizeRange(positions, src.position.first, kept, dst.positionMin, dst.positionStep);
+            for (int k : kept)
+            {
+                out.packedPositions.push_back(Pack(positions[src.position.first + k], dst.positionMin, dst.positionStep));
+                if (!IsResampled()) out.positionTimes.push_back(positionTimes[src.position.first + k]);
+            }
+
+            SelectKeys(src.rotation, rotationTimes, rotations, settings.rotationTolerance, quatLerp, quatError, kept, report);
+            dst.rotation = { (int)out.packedRotations.size(), (int)kept.size() };
+            for (int k : kept)
+            {
+                out.packedRotations.push_back(Pack(rotations[src.rotation.first + k]));
+                if (!IsResampled()) out.rotationTimes.push_back(rotationTimes[src.rotation.first + k]);
+            }
+
+            SelectKeys(src.scale, scaleTimes, scales, settings.scaleTolerance, vecLerp, vecError, kept, report);
+            dst.scale = { (int)out.packedScales.size(), (int)kept.size() };
+            QuantizeRange(scales, src.scale.first, kept, dst.scaleMin, dst.scaleStep);
+            for (int k : kept)
+            {
+                out.packedScales.push_back(Pack(scales[src.scale.first + k], dst.scaleMin, dst.scaleStep));
+                if (!IsResampled()) out.scaleTimes.push_back(scaleTimes[src.scale.first + k]);
+            }
+
+            out.channels.push_back(dst);
+        }
+        out.compressed = true;
+        *this = std::move(out);
+
+        report.bytesAfter = ByteSize();
+        report.keysAfter = KeyCount();
+        MeasureError(original, report);
+        return report;
+    }
+
+private:
+    static constexpr float QUAT_RANGE = 0.70710678f; // |smallest three| <= 1 / sqrt(2)
+
+    static float QuatAngle(const glm::quat& a, const glm::quat& b)
+    {
+        float d = glm::clamp(std::abs(glm::dot(a, b)), 0.0f, 1.0f);
+        return 2.0f * std::acos(d);
+    }
+
+    // fills 'kept' with the key indices (relative to range.first) that survive compression
+    template <typename T, typename Lerp, typename Error>
+    void SelectKeys(const Range& range, const std::vector<float>& times, const std::vector<T>& values, float tolerance,
+                    Lerp lerp, Error error, std::vector<int>& kept, CompressionReport& report) const
+    {
+        kept.clear();
+        kept.push_back(0);
+        if (range.count < 2) return;
+        const T* v = &values[range.first];
+
+        bool constant = true;
+        for (int i = 1; i < range.count && constant; i++)
+            constant = error(v[0], v[i]) <= tolerance;
+        if (constant)
+        {
+            report.constantTracks++;
+            return;
+        }
+        if (IsResampled())
+        {
+            for (int i = 1; i < range.count; i++) kept.push_back(i);
+            return;
+        }
+
+        // greedy: extend the segment from the last kept key as long as every skipped key is
+        // still reproduced within tolerance
+        const float* t = &times[range.first];
+        int anchor = 0;
+        for (int i = 1; i < range.count - 1; i++)
+        {
+            int next = i + 1;
+            float span = t[next] - t[anchor];
+            bool removable = span > 0.0f;
+            for (int k = anchor + 1; k <= i && removable; k++)
+                removable = error(lerp(v[anchor], v[next], (t[k] - t[anchor]) / span), v[k]) <= tolerance;
+            if (!removable)
+            {
+                kept.push_back(i);
+                anchor = i;
+            }
+        }
+        kept.push_back(range.count - 1);
+    }
+
+    static void QuantizeRange(const std::vector<glm::vec3>& values, int first, const std::vector<int>& kept, glm::vec3& min, glm::vec3& step)
+    {
+        min = values[first + kept[0]];
+        glm::vec3 max = min;
+        for (int k : kept)
+        {
+            min = glm::min(min, values[first + k]);
+            max = glm::max(max, values[first + k]);
+        }
+        step = (max - min) / 65535.0f;
+    }
+
+    static PackedVec3 Pack(const glm::vec3& value, const glm::vec3& min, const glm::vec3& step)
+    {
+        PackedVec3 p;
+        for (int i = 0; i < 3; i++)
+            p.v[i] = step[i] > 0.0f ? (uint16_t)std::lround(glm::clamp((value[i] - min[i]) / step[i], 0.0f, 65535.0f)) : 0;
+        return p;
+    }
+
+    static glm::vec3 Unpack(const PackedVec3& p, const glm::vec3& min, const glm::vec3& step)
+    {
+        return min + glm::vec3(p.v[0], p.v[1], p.v[2]) * step;
+    }
+
+    static PackedQuat Pack(glm::quat q)
+    {
+        q = glm::normalize(q);
+        float c[4] = { q.x, q.y, q.z, q.w };
+        int largest = 0;
+        for (int i = 1; i < 4; i++)
+            if (std::abs(c[i]) > std::abs(c[largest])) largest = i;
+        float sign = c[largest] < 0.0f ? -1.0f : 1.0f; // q and -q are the same rotation
+
+        uint64_t bits = (uint64_t)largest;
+        int shift = 2;
+        for (int i = 0; i < 4; i++)
+        {
+            if (i == largest) continue;
+            float n = glm::clamp(c[i] * sign / QUAT_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+            bits |= (uint64_t)std::lround(n * 32767.0f) << shift;
+            shift += 15;
+        }
+        PackedQuat p;
+        p.v[0] = (uint16_t)(bits & 0xFFFF);
+        p.v[1] = (uint16_t)((bits >> 16) & 0xFFFF);
+        p.v[2] = (uint16_t)((bits >> 32) & 0xFFFF);
+        return p;
+    }
+
+    static glm::quat Unpack(const PackedQuat& p)
+    {
+        uint64_t bits = (uint64_t)p.v[0] | ((uint64_t)p.v[1] << 16) | ((uint64_t)p.v[2] << 32);
+        int largest = (int)(bits & 3);
+        float c[4];
+        float sum = 0.0f;
+        int shift = 2;
+        for (int i = 0; i < 4; i++)
+        {
+            if (i == largest) continue;
+            float n = (float)((bits >> shift) & 0x7FFF) / 32767.0f;
+            c[i] = (n * 2.0f - 1.0f) * QUAT_RANGE;
+            sum += c[i] * c[i];
+            shift += 15;
+        }
+        c[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+        return glm::quat(c[3], c[0], c[1], c[2]);
+    }
+
+    // samples the compressed tracks at every key of the original clip
+    void MeasureError(const AnimationTracks& original, CompressionReport& report) const
+    {
+        for (int c = 0; c < (int)channels.size(); c++)
+        {
+            const Channel& before = original.channels[c];
+            const Channel& after = channels[c];
+            KeyCursor cursor;
+            for (int k = 0; k < before.position.count; k++)
+            {
+                float time = original.KeyTime(before.position, original.positionTimes, k);
+                float e = glm::length(SamplePosition(after, time, cursor) - original.positions[before.position.first + k]);
+                report.maxPositionError = std::max(report.maxPositionError, e);
+            }
+            for (int k = 0; k < before.rotation.count; k++)
+            {
+                float time = original.KeyTime(before.rotation, original.rotationTimes, k);
+                float e = QuatAngle(SampleRotation(after, time, cursor), glm::normalize(original.rotations[before.rotation.first + k]));
+                report.maxRotationError = std::max(report.maxRotationError, glm::degrees(e));
+            }
+            for (int k = 0; k < before.scale.count; k++)
+            {
+                float time = original.KeyTime(before.scale, original.scaleTimes, k);
+                float e = glm::length(SampleScale(after, time, cursor) - original.scales[before.scale.first + k]);
+                report.maxScaleError = std::max(report.maxScaleError, e);
+            }
+        }
+    }
+
+    float KeyTime(const Range& range, const std::vector<float>& times, int key) const
+    {
+        return IsResampled() ? key / sampleRate : times[range.first + key];
+    }
+
+    // returns the absolute index of the first key of the segment containing 'time' and the
+    // blend factor t towards the next key. resampled tracks index directly; keyed tracks scan
+    // forward from the cursor and only restart from the first key when time jumps backwards.
+    int Locate(const Range& range, const std::vector<float>& times, float time, int& cursor, float& t) const
+    {
+        t = 0.0f;
+        if (range.count < 2) return range.first;
+
+        if (IsResampled())
+        {
+            float f = glm::clamp(time * sampleRate, 0.0f, (float)(range.count - 1));
+            int i = std::min((int)f, range.count - 2);
+            t = f - (float)i;
+            return range.first + i;
+        }
+
+        const float* keys = &times[range.first];
+        int i = cursor;
+        if (i > range.count - 2 || time < keys[i]) i = 0;
+        while (i < range.count - 2 && time >= keys[i + 1]) i++;
+        cursor = i;
+
+        float span = keys[i + 1] - keys[i];
+        if (span > 0.0f) t = glm::clamp((time - keys[i]) / span, 0.0f, 1.0f);
+        return range.first + i;
+    }
+};
+#endif
@@ -6,7 +6,23 @@
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
 #include <learnopengl/animation.h>
-#include <learnopengl/bone.h>
+
+// One animation level of detail. Bands are checked in order and the first whose maxDistance
+// covers the character's distance is used (the last band catches everything further away).
+struct AnimationLodBand
+{
+    float maxDistance;    // world units from the camera
+    float updateInterval; // seconds between skeleton evaluations, 0 = every frame
+    int maxBoneDepth;     // deeper nodes (fingers, toes...) keep their last sampled pose, -1 = all
+};
+
+// Local transform of one animated node, kept split so poses can be interpolated
+struct BonePose
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+};
 
 class Animator
 {
@@ -26,61 +42,183 @@ public:
     void UpdateAnimation(float dt)
     {
         m_DeltaTime = dt;
-        if (m_CurrentAnimation)
+        if (!m_CurrentAnimation) return;
+
+        m_CurrentTime += m_CurrentAnimation->GetTicksPerSecond() * dt;
+        m_CurrentTime = fmod(m_CurrentTime, m_CurrentAnimation->GetDuration());
+
+        // hidden: keep the clock running but leave the last pose as is
+        if (!m_Visible)
+        {
+            m_PoseValid = false;
+            return;
+        }
+
+        const AnimationLodBand* band = SelectLodBand();
+        if (!band || band->updateInterval <= 0.0f)
+        {
+            CalculateBoneTransforms(m_CurrentTime, m_FinalBoneMatrices, band ? band->maxBoneDepth : -1);
+            m_PoseValid = false;
+            return;
+        }
+
+        // sparse updates: local poses are sampled every updateInterval seconds, one interval ahead
+        // of the clock, and every frame blends from the previous sampled pose towards that one
+        m_SinceLodUpdate += dt;
+        if (!m_PoseValid || m_SinceLodUpdate >= band->updateInterval)
         {
-            m_CurrentTime += m_CurrentAnimation->GetTicksPerSecond() * dt;
-            m_CurrentTime = fmod(m_CurrentTime, m_CurrentAnimation->GetDuration());
-            CalculateBoneTransform(&m_CurrentAnimation->GetRootNode(), glm::mat4(1.0f));
+            if (!m_PoseValid)
+            {
+                SamplePose(m_CurrentTime, band->maxBoneDepth);
+                m_PreviousPose = m_LocalPose;
+            }
+            else
+                m_PreviousPose.swap(m_NextPose);
+            float ahead = m_CurrentTime + m_CurrentAnimation->GetTicksPerSecond() * band->updateInterval;
+            SamplePose(fmod(ahead, m_CurrentAnimation->GetDuration()), band->maxBoneDepth);
+            m_NextPose = m_LocalPose;
+            m_SinceLodUpdate = 0.0f;
+            m_PoseValid = true;
         }
+        BlendPoses(glm::clamp(m_SinceLodUpdate / band->updateInterval, 0.0f, 1.0f));
     }
 
     void PlayAnimation(Animation* pAnimation)
     {
         m_CurrentAnimation = pAnimation;
         m_CurrentTime = 0.0f;
+        m_Cursors.assign(pAnimation ? pAnimation->GetChannelCount() : 0, KeyCursor());
+        m_PoseValid = false;
+    }
+
+    // distance bands for animation LOD, empty (the default) evaluates every frame at full detail
+    void SetLodBands(const std::vector<AnimationLodBand>& bands)
+    {
+        m_LodBands = bands;
+        m_PoseValid = false;
+    }
+
+    // per-frame input for LOD: camera distance and whether the character can be seen at all
+    void SetLodState(float distance, bool visible)
+    {
+        m_LodDistance = distance;
+        m_Visible = visible;
+    }
+
+    bool IsVisible() const { return m_Visible; }
+
+    // samples the clip at 'time' and walks the skeleton into out. nodes deeper than maxDepth
+    // (when >= 0) reuse their last sampled local transform.
+    void CalculateBoneTransforms(float time, std::vector<glm::mat4>& out, int maxDepth = -1)
+    {
+        SamplePose(time, maxDepth);
+        ComposePose(m_LocalPose, out);
+    }
+
+    const std::vector<glm::mat4>& GetFinalBoneMatrices() const
+    {
+        return m_FinalBoneMatrices;
     }
 
-    void CalculateBoneTransform(const AssimpNodeData* node, glm::mat4 parentTransform)
+private:
+    const AnimationLodBand* SelectLodBand() const
     {
-        std::string nodeName = node->name;
-        glm::mat4 nodeTransform = node->transformation;
+        if (m_LodBands.empty()) return nullptr;
+        for (const AnimationLodBand& band : m_LodBands)
+            if (m_LodDistance <= band.maxDistance) return &band;
+        return &m_LodBands.back();
+    }
 
-        Bone* Bone = m_CurrentAnimation->FindBone(nodeName);
+    // updates m_LocalPose for the animated nodes up to maxDepth. after a clip change every node
+    // is sampled once, so skipped nodes always hold a pose of the current clip.
+    void SamplePose(float time, int maxDepth)
+    {
+        const std::vector<SkeletonNode>& nodes = m_CurrentAnimation->GetNodes();
+        const AnimationTracks& tracks = m_CurrentAnimation->GetTracks();
+        if (m_Cursors.size() != tracks.channels.size())
+            m_Cursors.assign(tracks.channels.size(), KeyCursor());
+        if (m_LocalPoseAnimation != m_CurrentAnimation)
+        {
+            m_LocalPose.assign(nodes.size(), BonePose());
+            m_LocalPoseAnimation = m_CurrentAnimation;
+            maxDepth = -1;
+        }
 
-        if (Bone)
+        for (size_t i = 0; i < nodes.size(); i++)
         {
-            Bone->Update(m_CurrentTime);
-            nodeTransform = Bone->GetLocalTransform();
+            const SkeletonNode& node = nodes[i];
+            if (node.channel < 0 || (maxDepth >= 0 && node.depth > maxDepth)) continue;
+            const AnimationTracks::Channel& channel = tracks.channels[node.channel];
+            KeyCursor& cursor = m_Cursors[node.channel];
+            m_LocalPose[i].position = tracks.SamplePosition(channel, time, cursor);
+            m_LocalPose[i].rotation = tracks.SampleRotation(channel, time, cursor);
+            m_LocalPose[i].scale = tracks.SampleScale(channel, time, cursor);
         }
+    }
 
-        glm::mat4 globalTransformation = parentTransform * nodeTransform;
+    // walks the flattened skeleton once; parents precede children so their global transform
+    // is always ready. nodes the clip does not animate use their bind transform. scratch
+    // buffers only reallocate when a bigger skeleton is played.
+    void ComposePose(const std::vector<BonePose>& pose, std::vector<glm::mat4>& out)
+    {
+        const std::vector<SkeletonNode>& nodes = m_CurrentAnimation->GetNodes();
+        m_GlobalTransforms.resize(nodes.size());
+        if (out.size() < m_FinalBoneMatrices.size())
+            out.resize(m_FinalBoneMatrices.size(), glm::mat4(1.0f));
 
-        auto boneInfoMap = m_CurrentAnimation->GetBoneIDMap();
-        if (boneInfoMap.find(nodeName) != boneInfoMap.end())
+        for (size_t i = 0; i < nodes.size(); i++)
         {
-            int index = boneInfoMap[nodeName].id;
-            glm::mat4 offset = boneInfoMap[nodeName].offset;
+            const SkeletonNode& node = nodes[i];
 
-            // --- แก้ไขจุดที่ 2: ใส่เกราะกัน Crash (สำคัญมาก!) ---
-            // เช็คว่า Index ไม่เกินขนาดถังที่เราจองไว้
-            if (index < m_FinalBoneMatrices.size())
+            glm::mat4 nodeTransform = node.transformation;
+            if (node.channel >= 0)
             {
-                m_FinalBoneMatrices[index] = globalTransformation * offset;
+                const BonePose& local = pose[i];
+                nodeTransform = glm::translate(glm::mat4(1.0f), local.position) * glm::mat4_cast(local.rotation)
+                    * glm::scale(glm::mat4(1.0f), local.scale);
             }
-            // ------------------------------------------------
-        }
 
-        for (int i = 0; i < node->childrenCount; i++)
-            CalculateBoneTransform(&node->children[i], globalTransformation);
+            glm::mat4 globalTransformation = node.parent >= 0 ? m_GlobalTransforms[node.parent] * nodeTransform : nodeTransform;
+            m_GlobalTransforms[i] = globalTransformation;
+
+            // เช็คว่า Index ไม่เกินขนาดถังที่เราจองไว้
+            if (node.boneIndex >= 0 && node.boneIndex < (int)out.size())
+                out[node.boneIndex] = globalTransformation * node.offset;
+        }
     }
 
-    std::vector<glm::mat4> GetFinalBoneMatrices()
+    // interpolates the two sparse local poses (slerp for rotations, so bones turn rigidly instead
+    // of shrinking) and rebuilds the skeleton from the result
+    void BlendPoses(float t)
     {
-        return m_FinalBoneMatrices;
+        m_BlendedPose.resize(m_PreviousPose.size());
+        for (size_t i = 0; i < m_PreviousPose.size(); i++)
+        {
+            const BonePose& from = m_PreviousPose[i];
+            const BonePose& to = m_NextPose[i];
+            m_BlendedPose[i].position = glm::mix(from.position, to.position, t);
+            m_BlendedPose[i].rotation = glm::normalize(glm::slerp(from.rotation, to.rotation, t));
+            m_BlendedPose[i].scale = glm::mix(from.scale, to.scale, t);
+        }
+        ComposePose(m_BlendedPose, m_FinalBoneMatrices);
     }
 
-private:
     std::vector<glm::mat4> m_FinalBoneMatrices;
+    std::vector<glm::mat4> m_GlobalTransforms;
+    std::vector<BonePose> m_LocalPose; // last sampled local pose per node of the current clip
+    const Animation* m_LocalPoseAnimation = nullptr;
+
+    // animation LOD
+    std::vector<AnimationLodBand> m_LodBands;
+    std::vector<BonePose> m_PreviousPose;
+    std::vector<BonePose> m_NextPose;
+    std::vector<BonePose> m_BlendedPose;
+    float m_LodDistance = 0.0f;
+    float m_SinceLodUpdate = 0.0f;
+    bool m_Visible = true;
+    bool m_PoseValid = false;
+
+    std::vector<KeyCursor> m_Cursors; // per-channel key search positions for the current clip
     Animation* m_CurrentAnimation;
     float m_CurrentTime;
     float m_DeltaTime;
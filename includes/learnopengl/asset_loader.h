@@ -0,0 +1,121 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <learnopengl/model.h>
+#include <learnopengl/texture_loader.h>
+#include <learnopengl/texture_registry.h>
+#include <learnopengl/thread_pool.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+// Startup loading pipeline. Every job has a CPU part that starts on the worker pool as soon as it
+// is added (file reads, Assimp imports, image decodes, mesh packing) and an optional GL part.
+// Finish() runs on the GL thread: it takes jobs in the order their CPU part completes, runs their
+// GL part (buffer creation, texture uploads through a pixel buffer object) and reports progress.
+// Jobs that depend on each other (a model and the clips that add bones to it) belong in one job.
+class AssetLoader
+{
+public:
+    // completed and total count jobs, label is the job that just finished
+    using ProgressCallback = std::function<void(int completed, int total, const std::string& label)>;
+
+    explicit AssetLoader(ThreadPool& pool) : pool(pool) {}
+
+    void SetProgressCallback(ProgressCallback callback) { progress = std::move(callback); }
+
+    void Add(const std::string& label, std::function<void()> cpu, std::function<void()> gl = nullptr)
+    {
+        jobs.emplace_back();
+        Job& job = jobs.back();
+        job.label = label;
+        job.gl = std::move(gl);
+        int index = (int)jobs.size() - 1;
+        // workers keep a pointer, indexing the deque while the GL thread appends would race
+        Job* target = &job;
+        pool.Submit([this, index, target, cpu = std::move(cpu)]
+        {
+            Job& job = *target;
+            try
+            {
+                if (cpu) cpu();
+            }
+            catch (const std::exception& e)
+            {
+                job.error = e.what();
+                job.failed = true;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.push_back(index);
+            }
+            cpuDone.notify_one();
+        });
+    }
+
+    // imports the model on a worker (its textures decode as separate tasks), then runs 'then' on
+    // the same worker, e.g. to load the clips that need the model's bone map
+    void AddModel(Model& model, const std::string& path, std::function<void()> then = nullptr)
+    {
+        Add(path,
+            [this, &model, path, then = std::move(then)] { model.Import(path, &pool); if (then) then(); },
+            [this, &model] { model.Upload(&uploader); });
+    }
+
+    // decodes on a worker and acquires the texture from TextureRegistry on the GL thread, so the
+    // same file requested twice is decoded and uploaded once. wrapFor picks the wrap mode from the
+    // decoded image, GL_REPEAT when not given
+    void AddTexture(unsigned int& texture, const std::string& path, TextureRegistry::WrapRule wrapFor = nullptr)
+    {
+        Add(path,
+            [path] { TextureRegistry::Shared().Prefetch(path); },
+            [this, &texture, path, wrapFor = std::move(wrapFor)] { texture = TextureRegistry::Shared().Acquire(path, uploader, wrapFor); });
+    }
+
+    // blocks until every job added so far is done; must be called on the GL thread
+    void Finish()
+    {
+        int total = (int)jobs.size();
+        for (int done = 0; done < total; done++)
+        {
+            int index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cpuDone.wait(lock, [this] { return !completed.empty(); });
+                index = completed.front();
+                completed.pop_front();
+            }
+            Job& job = jobs[index];
+            if (job.failed)
+                std::cout << "ERROR::LOADER::" << job.label << ": " << job.error << std::endl;
+            else if (job.gl)
+                job.gl();
+            if (progress) progress(done + 1, total, job.label);
+        }
+        jobs.clear();
+        uploader.Release();
+    }
+
+private:
+    struct Job
+    {
+        std::string label;
+        std::function<void()> gl;
+        std::string error;
+        bool failed = false;
+    };
+
+    ThreadPool& pool;
+    TextureUploader uploader;
+    ProgressCallback progress;
+    std::deque<Job> jobs; // deque, so appending never moves a job a worker is using
+    std::deque<int> completed;
+    std::mutex mutex;
+    std::condition_variable cpuDone;
+};
+#endif
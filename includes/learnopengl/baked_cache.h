@@ -0,0 +1,214 @@
+#ifndef BAKED_CACHE_H
+#define BAKED_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary cache files written next to an imported asset (e.g. "Jump.dae.anim.bake") so later runs
+// can skip Assimp. Every file starts with a header that ties it to its source:
+//   magic, format version, kind, parameters, source size, source mtime, source hash
+// A cache is used when kind, version and parameters match and the source still has the recorded
+// size and mtime; if only the mtime changed (fresh checkout, touched file) the source is hashed
+// and the cache is kept when the content is the same. Anything else means rebuild from source.
+// The payload is a plain sequence of native-endian PODs, strings and POD vectors; reader and
+// writer of each kind must agree on the order, bump VERSION whenever a payload changes.
+class BakedCache
+{
+public:
+    static constexpr uint32_t MAGIC = 0x454B4142; // "BAKE"
+    static constexpr uint32_t VERSION = 1;
+
+    enum Kind : uint32_t
+    {
+        MODEL = 1,
+        ANIMATION = 2,
+        TEXTURE = 3
+    };
+
+    static std::string PathFor(const std::string& source, Kind kind)
+    {
+        switch (kind)
+        {
+        case MODEL:     return source + ".model.bake";
+        case ANIMATION: return source + ".anim.bake";
+        default:        return source + ".tex.bake";
+        }
+    }
+
+    struct Stamp
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+    };
+
+    // size and mtime only; hash is filled in on demand
+    static bool StampOf(const std::string& source, Stamp& stamp)
+    {
+        std::error_code error;
+        stamp.size = (uint64_t)std::filesystem::file_size(source, error);
+        if (error) return false;
+        auto time = std::filesystem::last_write_time(source, error);
+        if (error) return false;
+        stamp.mtime = (int64_t)time.time_since_epoch().count();
+        return true;
+    }
+
+    // FNV-1a over the file content, 0 if it cannot be read
+    static uint64_t HashFile(const std::string& source)
+    {
+        std::ifstream file(source, std::ios::binary);
+        if (!file) return 0;
+        uint64_t hash = 14695981039346656037ull;
+        char buffer[64 * 1024];
+        while (file)
+        {
+            file.read(buffer, sizeof(buffer));
+            std::streamsize n = file.gcount();
+            for (std::streamsize i = 0; i < n; i++)
+                hash = (hash ^ (unsigned char)buffer[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    class Writer
+    {
+    public:
+        // writes to a temporary file that Commit() moves into place, so an interrupted bake never
+        // leaves a truncated cache behind
+        Writer(const std::string& source, Kind kind, uint64_t parameters)
+            : path(PathFor(source, kind)), temporary(path + ".tmp"), file(temporary, std::ios::binary)
+        {
+            Stamp stamp;
+            if (!StampOf(source, stamp))
+            {
+                file.close();
+                return;
+            }
+            stamp.hash = HashFile(source);
+            Write(MAGIC);
+            Write(VERSION);
+            Write((uint32_t)kind);
+            Write(parameters);
+            Write(stamp);
+        }
+
+        template <typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Write needs a POD");
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void WriteString(const std::string& value)
+        {
+            Write((uint32_t)value.size());
+            file.write(value.data(), value.size());
+        }
+
+        template <typename T>
+        void WriteVector(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "WriteVector needs a POD element type");
+            Write((uint32_t)values.size());
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        bool Commit()
+        {
+            bool ok = file.is_open() && file.good();
+            file.close();
+            std::error_code error;
+            if (ok) std::filesystem::rename(temporary, path, error);
+            if (!ok || error)
+            {
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        std::string path;
+        std::string temporary;
+        std::ofstream file;
+    };
+
+    class Reader
+    {
+    public:
+        // opens the cache for source and validates its header, check Valid() before reading
+        Reader(const std::string& source, Kind kind, uint64_t parameters)
+            : file(PathFor(source, kind), std::ios::binary)
+        {
+            if (!file)
+            {
+                ok = false;
+                return;
+            }
+            uint32_t magic = 0, version = 0, storedKind = 0;
+            uint64_t storedParameters = 0;
+            Stamp stored, current;
+            Read(magic);
+            Read(version);
+            Read(storedKind);
+            Read(storedParameters);
+            Read(stored);
+            if (!ok || magic != MAGIC || version != VERSION || storedKind != (uint32_t)kind || storedParameters != parameters)
+            {
+                ok = false;
+                return;
+            }
+            if (!StampOf(source, current) || current.size != stored.size)
+            {
+                ok = false;
+                return;
+            }
+            if (current.mtime != stored.mtime && HashFile(source) != stored.hash)
+                ok = false;
+        }
+
+        bool Valid() const { return ok; }
+
+        template <typename T>
+        bool Read(T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Read needs a POD");
+            if (ok && !file.read(reinterpret_cast<char*>(&value), sizeof(T))) ok = false;
+            return ok;
+        }
+
+        bool ReadString(std::string& value)
+        {
+            uint32_t size = 0;
+            if (!Read(size) || size > MAX_ELEMENTS) return ok = false;
+            value.resize(size);
+            if (size && !file.read(&value[0], size)) ok = false;
+            return ok;
+        }
+
+        template <typename T>
+        bool ReadVector(std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "ReadVector needs a POD element type");
+            uint32_t size = 0;
+            if (!Read(size) || size > MAX_ELEMENTS) return ok = false;
+            values.resize(size);
+            if (size && !file.read(reinterpret_cast<char*>(values.data()), (std::streamsize)size * sizeof(T))) ok = false;
+            return ok;
+        }
+
+    private:
+        // guards allocations against a corrupt length prefix
+        static constexpr uint32_t MAX_ELEMENTS = 1u << 28;
+
+        std::ifstream file;
+        bool ok = true;
+    };
+};
+#endif
@@ -0,0 +1,97 @@
+#ifndef BONE_PALETTE_H
+#define BONE_PALETTE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Frame-wide store for skinning matrices, exposed to shaders as a samplerBuffer (RGBA32F texture
+// buffer, four texels per matrix). Each skinned character appends its palette with Add() (or
+// Reserve() + Data() to fill it later), sized to the bones the skeleton actually has, and gets
+// the palette's offset back; Upload() then
+// pushes every palette of the frame to the GPU in one write. Draws select their palette by setting
+// the boneOffset uniform, so any number of palettes stay resident at once.
+class BonePalette
+{
+public:
+    static constexpr GLuint TEXTURE_UNIT = 7; // above the material units used by Mesh::Draw
+    static constexpr const char* SAMPLER_NAME = "bonePalette";
+
+    unsigned int TBO = 0;
+    unsigned int texture = 0;
+
+    void Init(int initialCapacity = 1024)
+    {
+        capacity = initialCapacity;
+        glGenBuffers(1, &TBO);
+        glBindBuffer(GL_TEXTURE_BUFFER, TBO);
+        glBufferData(GL_TEXTURE_BUFFER, capacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, TBO);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        staging.reserve(capacity);
+    }
+
+    // starts a new frame, palettes added in the previous frame are discarded
+    void Begin()
+    {
+        staging.clear();
+    }
+
+    // appends count matrices and returns the offset (in matrices) to pass to the shader
+    int Add(const glm::mat4* matrices, int count)
+    {
+        int offset = (int)staging.size();
+        staging.insert(staging.end(), matrices, matrices + count);
+        return offset;
+    }
+
+    // reserves count matrices to be filled later through Data(); reserve every palette of the
+    // frame before writing any of them, as reserving may move the storage
+    int Reserve(int count)
+    {
+        int offset = (int)staging.size();
+        staging.resize(staging.size() + count);
+        return offset;
+    }
+
+    glm::mat4* Data(int offset)
+    {
+        return staging.data() + offset;
+    }
+
+    // single upload of everything added since Begin(); the store is orphaned first so the driver
+    // never has to wait for last frame's draws to finish reading it
+    void Upload()
+    {
+        if (staging.empty()) return;
+        glBindBuffer(GL_TEXTURE_BUFFER, TBO);
+        if ((int)staging.size() > capacity)
+            capacity = (int)staging.capacity();
+        glBufferData(GL_TEXTURE_BUFFER, capacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, staging.size() * sizeof(glm::mat4), staging.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void Bind() const
+    {
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void Release()
+    {
+        if (texture) glDeleteTextures(1, &texture);
+        if (TBO) glDeleteBuffers(1, &TBO);
+        texture = TBO = 0;
+    }
+
+private:
+    int capacity = 0;
+    std::vector<glm::mat4> staging;
+};
+#endif
@@ -0,0 +1,53 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// CPU mirror of the std140 "FrameData" uniform block declared by the programs in shaders/.
+// vec3 values are stored as vec4 because std140 pads them to 16 bytes anyway.
+struct FrameData
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 viewPos;
+    glm::vec4 lightDirection;
+    glm::vec4 lightAmbient;
+    glm::vec4 lightDiffuse;
+    glm::vec4 lightSpecular;
+};
+
+// Owns the per-frame uniform buffer. Every program binds its FrameData block to BINDING once
+// after linking (Shader::bindUniformBlock), then the camera and light state reaches all of them
+// through a single buffer write per frame.
+class FrameUniforms
+{
+public:
+    static constexpr GLuint BINDING = 0;
+    static constexpr const char* BLOCK_NAME = "FrameData";
+
+    unsigned int UBO = 0;
+
+    void Init()
+    {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, UBO);
+    }
+
+    void Update(const FrameData& data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void Release()
+    {
+        if (UBO) glDeleteBuffers(1, &UBO);
+        UBO = 0;
+    }
+};
+#endif
@@ -0,0 +1,128 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+
+// axis aligned box, empty until the first point is added
+struct BoundingBox
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    bool Valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    void Expand(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void Expand(const BoundingBox& box)
+    {
+        if (!box.Valid()) return;
+        Expand(box.min);
+        Expand(box.max);
+    }
+
+    // grows every side by margin, e.g. to leave room for animation around a bind pose box
+    BoundingBox Padded(float margin) const
+    {
+        BoundingBox box = *this;
+        if (!Valid()) return box;
+        box.min -= glm::vec3(margin);
+        box.max += glm::vec3(margin);
+        return box;
+    }
+
+    // box around this one after transform (Arvo's method, no corner enumeration)
+    BoundingBox Transformed(const glm::mat4& transform) const
+    {
+        if (!Valid()) return *this;
+        BoundingBox box;
+        box.min = box.max = glm::vec3(transform[3]);
+        for (int column = 0; column < 3; column++)
+        {
+            glm::vec3 axis = glm::vec3(transform[column]);
+            glm::vec3 a = axis * min[column];
+            glm::vec3 b = axis * max[column];
+            box.min += glm::min(a, b);
+            box.max += glm::max(a, b);
+        }
+        return box;
+    }
+};
+
+// objects tested against the frustum in a frame, how many of them were skipped, and how many
+// were rejected before the test as hidden behind the level (potentially visible sets)
+struct CullStats
+{
+    unsigned int submitted = 0;
+    unsigned int culled = 0;
+    unsigned int occluded = 0;
+
+    void Reset() { submitted = culled = occluded = 0; }
+
+    // counts the object and passes the test result through
+    bool Record(bool visible)
+    {
+        if (visible) submitted++; else culled++;
+        return visible;
+    }
+};
+
+// The six planes of a view frustum, extracted from projection * view (Gribb & Hartmann).
+// Planes point inwards and are normalized, a box is outside when it lies completely behind one.
+// The test is conservative: boxes near a frustum corner may pass while being outside.
+class Frustum
+{
+public:
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& viewProjection) { Update(viewProjection); }
+
+    void Update(const glm::mat4& viewProjection)
+    {
+        // glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++)
+            rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        planes[0] = rows[3] + rows[0]; // left
+        planes[1] = rows[3] - rows[0]; // right
+        planes[2] = rows[3] + rows[1]; // bottom
+        planes[3] = rows[3] - rows[1]; // top
+        planes[4] = rows[3] + rows[2]; // near
+        planes[5] = rows[3] - rows[2]; // far
+        for (glm::vec4& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // invalid (empty) boxes are treated as visible, so objects without bounds are never lost
+    bool Intersects(const BoundingBox& box) const
+    {
+        if (!box.Valid()) return true;
+        for (const glm::vec4& plane : planes)
+        {
+            // corner furthest along the plane normal
+            glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x,
+                             plane.y >= 0.0f ? box.max.y : box.min.y,
+                             plane.z >= 0.0f ? box.max.z : box.min.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    bool Intersects(const glm::vec3& center, float radius) const
+    {
+        for (const glm::vec4& plane : planes)
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                return false;
+        return true;
+    }
+
+private:
+    glm::vec4 planes[6];
+};
+#endif
@@ -0,0 +1,198 @@
+#ifndef GPU_PARTICLES_H
+#define GPU_PARTICLES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader_m.h>
+
+#include <cstdint>
+#include <vector>
+
+// Particles that live in GPU memory only. Two vertex buffers take turns: Update() draws every
+// slot of one as points through a transform feedback program (shaders/particle_update.vs) that
+// writes the aged and moved particles into the other, with rasterization off. Emit() only records
+// a small command (slots, center, seed, burst); the update pass initializes the slots it covers
+// from a hash of the seed, so a burst costs no CPU work or uploads beyond a few uniforms. Slots
+// are handed out as a ring and overwrite the oldest particles once it wraps. Draw() renders the
+// latest buffer as point sprites in one call, dead particles are clipped by the vertex shader.
+class GpuParticles
+{
+public:
+    static constexpr int MAX_EMITS = 16; // must match MAX_EMITS in particle_update.vs
+
+    struct Burst
+    {
+        float spread = 0.5f;         // radius of the ball spawn positions are taken from
+        float speed = 2.0f;          // radius of the ball velocities are taken from
+        float lift = 1.0f;           // added to the absolute upward velocity
+        glm::vec4 color = glm::vec4(1.0f);
+        float life = 1.0f;           // seconds
+    };
+
+    // capacity slots, simulated by updateShader (built with the PositionLife, Velocity and Color
+    // feedback varyings)
+    void Init(int capacity, const Shader& updateShader)
+    {
+        Release();
+        this->capacity = capacity;
+        updateProgram = updateShader.ID;
+        capacityUniform = updateShader.uniform<int>("capacity");
+        deltaTimeUniform = updateShader.uniform<float>("deltaTime");
+        fadeRateUniform = updateShader.uniform<float>("fadeRate");
+        emitTotalUniform = updateShader.uniform<int>("emitTotal");
+        emitFirstUniform = updateShader.uniform<int>("emitFirst");
+        emitCountUniform = updateShader.uniform<int>("emitCount");
+        emitSeedUniform = updateShader.uniform<int>("emitSeed");
+        emitCenterUniform = updateShader.uniform<glm::vec3>("emitCenter");
+        emitMotionUniform = updateShader.uniform<glm::vec4>("emitMotion");
+        emitColorUniform = updateShader.uniform<glm::vec4>("emitColor");
+
+        // zeroed particles have no life left, so every slot starts out dead
+        std::vector<GpuParticle> empty(capacity);
+        glGenBuffers(2, VBO);
+        glGenVertexArrays(2, VAO);
+        for (int i = 0; i < 2; i++)
+        {
+            glBindVertexArray(VAO[i]);
+            glBindBuffer(GL_ARRAY_BUFFER, VBO[i]);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(GpuParticle), empty.data(), GL_DYNAMIC_COPY);
+            // 0: position and remaining life, 1: velocity, 2: color
+            for (GLuint attribute = 0; attribute < 3; attribute++)
+            {
+                glEnableVertexAttribArray(attribute);
+                glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)(attribute * sizeof(glm::vec4)));
+            }
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        current = 0;
+        cursor = 0;
+        emits.clear();
+        emits.reserve(MAX_EMITS);
+    }
+
+    void Release()
+    {
+        if (VAO[0]) glDeleteVertexArrays(2, VAO);
+        if (VBO[0]) glDeleteBuffers(2, VBO);
+        VAO[0] = VAO[1] = 0;
+        VBO[0] = VBO[1] = 0;
+        capacity = 0;
+        emits.clear();
+    }
+
+    // queues count particles around center for the next Update(); false once MAX_EMITS commands
+    // are waiting, the burst is then dropped
+    bool Emit(const glm::vec3& center, int count, const Burst& burst)
+    {
+        if (capacity == 0 || count <= 0 || (int)emits.size() == MAX_EMITS) return false;
+        if (count > capacity) count = capacity;
+        Command command;
+        command.first = cursor;
+        command.count = count;
+        command.seed = (int)(nextSeed() >> 1);
+        command.center = center;
+        command.motion = glm::vec4(burst.spread, burst.speed, burst.lift, burst.life);
+        command.color = burst.color;
+        emits.push_back(command);
+        cursor = (cursor + count) % capacity;
+        return true;
+    }
+
+    // applies the queued emits and advances every particle by dt, fading by fadeRate per second
+    void Update(float dt, float fadeRate)
+    {
+        if (capacity == 0) return;
+        glUseProgram(updateProgram);
+        capacityUniform.set(capacity);
+        deltaTimeUniform.set(dt);
+        fadeRateUniform.set(fadeRate);
+        int total = (int)emits.size();
+        emitTotalUniform.set(total);
+        if (total > 0)
+        {
+            int first[MAX_EMITS], count[MAX_EMITS], seed[MAX_EMITS];
+            glm::vec3 center[MAX_EMITS];
+            glm::vec4 motion[MAX_EMITS], color[MAX_EMITS];
+            for (int i = 0; i < total; i++)
+            {
+                first[i] = emits[i].first;
+                count[i] = emits[i].count;
+                seed[i] = emits[i].seed;
+                center[i] = emits[i].center;
+                motion[i] = emits[i].motion;
+                color[i] = emits[i].color;
+            }
+            emitFirstUniform.set(first, total);
+            emitCountUniform.set(count, total);
+            emitSeedUniform.set(seed, total);
+            emitCenterUniform.set(center, total);
+            emitMotionUniform.set(motion, total);
+            emitColorUniform.set(color, total);
+            emits.clear();
+        }
+
+        glEnable(GL_RASTERIZER_DISCARD);
+        glBindVertexArray(VAO[current]);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, VBO[1 - current]);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, capacity);
+        glEndTransformFeedback();
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        glBindVertexArray(0);
+        glDisable(GL_RASTERIZER_DISCARD);
+        current = 1 - current;
+    }
+
+    // every slot as a point, with the render program (shaders/particle.vs) already in use
+    void Draw() const
+    {
+        if (capacity == 0) return;
+        glBindVertexArray(VAO[current]);
+        glDrawArrays(GL_POINTS, 0, capacity);
+        glBindVertexArray(0);
+    }
+
+    int Capacity() const { return capacity; }
+
+private:
+    struct GpuParticle
+    {
+        glm::vec4 positionLife = glm::vec4(0.0f);
+        glm::vec4 velocity = glm::vec4(0.0f);
+        glm::vec4 color = glm::vec4(0.0f);
+    };
+
+    struct Command
+    {
+        int first, count, seed;
+        glm::vec3 center;
+        glm::vec4 motion; // spread, speed, lift, life
+        glm::vec4 color;
+    };
+
+    unsigned int VAO[2] = { 0, 0 };
+    unsigned int VBO[2] = { 0, 0 };
+    int current = 0; // buffer holding the latest state
+    int capacity = 0;
+    int cursor = 0;  // next slot to emit into
+    unsigned int updateProgram = 0;
+    std::vector<Command> emits;
+    uint32_t seedState = 0x9E3779B9u;
+
+    Shader::Uniform<int> capacityUniform, emitTotalUniform, emitFirstUniform, emitCountUniform, emitSeedUniform;
+    Shader::Uniform<float> deltaTimeUniform, fadeRateUniform;
+    Shader::Uniform<glm::vec3> emitCenterUniform;
+    Shader::Uniform<glm::vec4> emitMotionUniform, emitColorUniform;
+
+    // xorshift32, the shader hashes the seed again per slot
+    uint32_t nextSeed()
+    {
+        seedState ^= seedState << 13;
+        seedState ^= seedState >> 17;
+        seedState ^= seedState << 5;
+        return seedState;
+    }
+};
+#endif
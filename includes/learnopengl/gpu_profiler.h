@@ -0,0 +1,149 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GPU time per render section from GL_TIMESTAMP queries written around it. Each frame uses its
+// own slot of queries and a slot is read back FRAMES_IN_FLIGHT frames later, once the GPU is done
+// with it, so reading never stalls the pipeline; a result that is still not available is dropped.
+// Averages cover the last WINDOW frames; a section skipped in a frame (e.g. nothing to draw)
+// counts as 0 ms there, so the averages are per frame and add up to the frame's GPU time.
+// Sections are added before Init().
+// While disabled every call returns right away and no queries are issued.
+class GpuProfiler
+{
+public:
+    static constexpr int FRAMES_IN_FLIGHT = 4;
+    static constexpr int WINDOW = 60;
+
+    int AddSection(const std::string& name)
+    {
+        sections.push_back(Section{ name });
+        return (int)sections.size() - 1;
+    }
+
+    void Init()
+    {
+        queries.resize((size_t)FRAMES_IN_FLIGHT * sections.size() * 2);
+        issued.assign((size_t)FRAMES_IN_FLIGHT * sections.size(), 0);
+        framePending.assign(FRAMES_IN_FLIGHT, 0);
+        if (!queries.empty())
+            glGenQueries((GLsizei)queries.size(), queries.data());
+    }
+
+    void Release()
+    {
+        if (!queries.empty())
+            glDeleteQueries((GLsizei)queries.size(), queries.data());
+        queries.clear();
+        issued.clear();
+        framePending.clear();
+    }
+
+    // disabling drops the queries in flight and the averages
+    void SetEnabled(bool enable)
+    {
+        if (enable == enabled) return;
+        enabled = enable;
+        issued.assign(issued.size(), 0);
+        framePending.assign(framePending.size(), 0);
+        for (Section& section : sections)
+            section = Section{ section.name };
+    }
+
+    bool IsEnabled() const { return enabled; }
+
+    // collects the slot this frame is about to reuse
+    void BeginFrame()
+    {
+        if (!enabled) return;
+        slot = (slot + 1) % FRAMES_IN_FLIGHT;
+        bool collect = framePending[slot] != 0;
+        framePending[slot] = 1;
+        for (int s = 0; s < (int)sections.size() && collect; s++)
+        {
+            char& pending = issued[slot * sections.size() + s];
+            if (!pending)
+            {
+                addSample(sections[s], 0.0f);
+                continue;
+            }
+            pending = 0;
+            GLint available = 0;
+            glGetQueryObjectiv(query(s, 1), GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(query(s, 0), GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(query(s, 1), GL_QUERY_RESULT, &end);
+            addSample(sections[s], end > start ? (float)((end - start) / 1.0e6) : 0.0f);
+        }
+    }
+
+    void Begin(int section)
+    {
+        if (!enabled) return;
+        glQueryCounter(query(section, 0), GL_TIMESTAMP);
+    }
+
+    void End(int section)
+    {
+        if (!enabled) return;
+        glQueryCounter(query(section, 1), GL_TIMESTAMP);
+        issued[slot * sections.size() + section] = 1;
+    }
+
+    int SectionCount() const { return (int)sections.size(); }
+    const std::string& Name(int section) const { return sections[section].name; }
+
+    // rolling per-frame average in milliseconds, 0 before the first sample
+    float AverageMs(int section) const
+    {
+        const Section& s = sections[section];
+        return s.count ? s.sum / s.count : 0.0f;
+    }
+
+    // average GPU time of the profiled sections per frame
+    float TotalMs() const
+    {
+        float total = 0.0f;
+        for (int s = 0; s < (int)sections.size(); s++)
+            total += AverageMs(s);
+        return total;
+    }
+
+private:
+    struct Section
+    {
+        std::string name;
+        float samples[WINDOW] = {};
+        float sum = 0.0f;
+        int count = 0;
+        int next = 0;
+    };
+
+    std::vector<Section> sections;
+    std::vector<GLuint> queries; // [slot][section][start, end]
+    std::vector<char> issued;    // [slot][section], end query written and not read yet
+    std::vector<char> framePending; // [slot], a profiled frame used the slot and was not read yet
+    bool enabled = false;
+    int slot = 0;
+
+    GLuint query(int section, int end) const
+    {
+        return queries[((size_t)slot * sections.size() + section) * 2 + end];
+    }
+
+    static void addSample(Section& section, float ms)
+    {
+        if (section.count == WINDOW) section.sum -= section.samples[section.next];
+        else section.count++;
+        section.samples[section.next] = ms;
+        section.sum += ms;
+        section.next = (section.next + 1) % WINDOW;
+    }
+};
+#endif
@@ -0,0 +1,97 @@
+#ifndef IMPORT_CACHE_H
+#define IMPORT_CACHE_H
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/config.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Keeps the Assimp scene of every source file imported during loading, so a file that is both a
+// Model and an Animation (the air gun) is parsed once. Animation-only requests import without
+// mesh post-processing and strip meshes, materials and textures right after parsing; a later full
+// request for the same file reimports it. Clear() once loading is done to give the memory back.
+// Safe to use from several loader threads, each file is imported at most once at a time.
+class ImportCache
+{
+public:
+    enum Usage
+    {
+        FULL,           // meshes, materials and animations, post-processed for Model
+        ANIMATION_ONLY  // node tree and animations only
+    };
+
+    // keeps the importer (and so the scene) alive for as long as the handle exists
+    struct Scene
+    {
+        std::shared_ptr<Assimp::Importer> owner;
+        const aiScene* scene = nullptr;
+        std::string error;
+
+        const aiScene* operator->() const { return scene; }
+        explicit operator bool() const { return scene != nullptr; }
+    };
+
+    static constexpr unsigned int FULL_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace;
+
+    // process-wide cache shared by Model and Animation
+    static ImportCache& Shared()
+    {
+        static ImportCache cache;
+        return cache;
+    }
+
+    Scene Get(const std::string& path, Usage usage)
+    {
+        std::shared_ptr<Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::shared_ptr<Entry>& slot = entries[path];
+            if (!slot) slot = std::make_shared<Entry>();
+            entry = slot;
+        }
+
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        if (entry->scene.scene && (entry->usage == FULL || usage == ANIMATION_ONLY))
+            return entry->scene;
+
+        auto importer = std::make_shared<Assimp::Importer>();
+        unsigned int flags = FULL_FLAGS;
+        if (usage == ANIMATION_ONLY)
+        {
+            importer->SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_MESHES | aiComponent_MATERIALS | aiComponent_TEXTURES
+                                                                 | aiComponent_LIGHTS | aiComponent_CAMERAS);
+            flags = aiProcess_RemoveComponent;
+        }
+        Scene result;
+        result.scene = importer->ReadFile(path, flags);
+        result.owner = importer;
+        if (!result.scene) result.error = importer->GetErrorString();
+        entry->scene = result;
+        entry->usage = usage;
+        return result;
+    }
+
+    // drops every cached scene; handles still held elsewhere stay valid until released
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+    }
+
+private:
+    struct Entry
+    {
+        std::mutex mutex;
+        Scene scene;
+        Usage usage = ANIMATION_ONLY;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<Entry>> entries;
+};
+#endif
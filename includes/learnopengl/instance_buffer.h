@@ -0,0 +1,100 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Per-instance model matrices in a vertex buffer, read by instanced draws at attribute locations
+// FIRST_LOCATION .. FIRST_LOCATION + 3 (see Model::SetInstanceBuffer). Instances carry the
+// caller's ids (e.g. barrel indices) and are packed at the front of the buffer: Assign() uploads a
+// whole set, Remove() moves the last instance into the freed slot, so removing one writes a
+// single matrix instead of rebuilding the buffer. Matches() tells whether a set of ids is already
+// the one in the buffer, so callers only upload when it changed.
+class InstanceBuffer
+{
+public:
+    static constexpr GLuint FIRST_LOCATION = 7;
+
+    unsigned int VBO = 0;
+
+    void Init(int capacity)
+    {
+        Release();
+        this->capacity = capacity;
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // replaces the instances, transforms[i] belongs to ids[i]; ids past the capacity are dropped
+    void Assign(const std::vector<int>& ids, const std::vector<glm::mat4>& transforms)
+    {
+        for (int id : idAt)
+            slotOf[id] = -1;
+        idAt.clear();
+        this->transforms.clear();
+        for (size_t i = 0; i < ids.size() && (int)i < capacity; i++)
+        {
+            if (ids[i] >= (int)slotOf.size()) slotOf.resize(ids[i] + 1, -1);
+            slotOf[ids[i]] = (int)idAt.size();
+            idAt.push_back(ids[i]);
+            this->transforms.push_back(transforms[i]);
+        }
+        if (this->transforms.empty()) return;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, this->transforms.size() * sizeof(glm::mat4), this->transforms.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // false if the id has no instance
+    bool Remove(int id)
+    {
+        if (id < 0 || id >= (int)slotOf.size() || slotOf[id] < 0) return false;
+        int slot = slotOf[id];
+        int last = (int)idAt.size() - 1;
+        slotOf[id] = -1;
+        if (slot != last)
+        {
+            idAt[slot] = idAt[last];
+            transforms[slot] = transforms[last];
+            slotOf[idAt[slot]] = slot;
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)slot * sizeof(glm::mat4), sizeof(glm::mat4), &transforms[slot]);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        idAt.pop_back();
+        transforms.pop_back();
+        return true;
+    }
+
+    // true if the instances are exactly ids, in any order (ids must not repeat)
+    bool Matches(const std::vector<int>& ids) const
+    {
+        if (ids.size() != idAt.size()) return false;
+        for (int id : ids)
+            if (id < 0 || id >= (int)slotOf.size() || slotOf[id] < 0) return false;
+        return true;
+    }
+
+    GLsizei Count() const { return (GLsizei)idAt.size(); }
+
+    void Release()
+    {
+        if (VBO) glDeleteBuffers(1, &VBO);
+        VBO = 0;
+        capacity = 0;
+        slotOf.clear();
+        idAt.clear();
+        transforms.clear();
+    }
+
+private:
+    int capacity = 0;
+    std::vector<int> slotOf;           // id -> slot, -1 without an instance
+    std::vector<int> idAt;             // slot -> id
+    std::vector<glm::mat4> transforms; // CPU copy of the packed buffer
+};
+#endif
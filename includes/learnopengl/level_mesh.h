@@ -0,0 +1,373 @@
+#ifndef LEVEL_MESH_H
+#define LEVEL_MESH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/frustum.h>
+#include <learnopengl/render_queue.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bakes a character grid into static geometry once at load time.
+// '#' is a solid wall block, '-' and '|' are thin walls, every other tile is floor.
+// Coplanar faces of neighbouring tiles are merged into single quads and faces that can never
+// be seen (between two blocks, under a block, against the map border) are dropped, so the whole
+// level draws in two indexed calls with an identity model matrix.
+// Merging stops at the border of each CHUNK_TILES x CHUNK_TILES chunk and chunks are stored one
+// after another, so the frustum culled draws submit just the index ranges of visible chunks, still
+// in one call per batch.
+// Vertices use the same layout as the old cube VBO (position, normal, texcoords), so the
+// static_model shaders render the result unchanged.
+class LevelMesh
+{
+public:
+    static constexpr float WALL_HEIGHT = 12.0f;
+    static constexpr float THIN_WALL_DEPTH = 0.5f;
+    static constexpr int CHUNK_TILES = 8;
+
+    struct Batch
+    {
+        unsigned int VAO = 0;
+        unsigned int VBO = 0;
+        unsigned int EBO = 0;
+        unsigned int indexCount = 0;
+        // visible ranges of the last culled draw or submit, joined for glMultiDrawElements
+        mutable std::vector<GLsizei> drawCounts;
+        mutable std::vector<const void*> drawOffsets;
+    };
+
+    // index range of one chunk inside a batch
+    struct Range
+    {
+        unsigned int first = 0;
+        unsigned int count = 0;
+    };
+
+    struct Chunk
+    {
+        BoundingBox bounds; // walls and floor of the chunk
+        Range walls;
+        Range floor;
+    };
+
+    Batch walls;
+    Batch floor;
+    std::vector<Chunk> chunks;
+
+    void Bake(const std::vector<std::string>& layout, float tileSize)
+    {
+        Release();
+        tile = tileSize;
+        height = (int)layout.size();
+        width = 0;
+        for (const std::string& row : layout)
+            width = std::max(width, (int)row.size());
+
+        chunksX = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+
+        std::vector<float> wallVertices, floorVertices;
+        std::vector<unsigned int> wallIndices, floorIndices;
+        const float half = tile * 0.5f;
+        for (int z0 = 0; z0 < height; z0 += CHUNK_TILES)
+        {
+            for (int x0 = 0; x0 < width; x0 += CHUNK_TILES)
+            {
+                int x1 = std::min(x0 + CHUNK_TILES, width);
+                int z1 = std::min(z0 + CHUNK_TILES, height);
+                Chunk chunk;
+                chunk.bounds.Expand(glm::vec3(x0 * tile - half, 0.0f, z0 * tile - half));
+                chunk.bounds.Expand(glm::vec3(x1 * tile - half, WALL_HEIGHT, z1 * tile - half));
+                chunk.walls.first = (unsigned int)wallIndices.size();
+                bakeWalls(layout, x0, z0, x1, z1, wallVertices, wallIndices);
+                chunk.walls.count = (unsigned int)wallIndices.size() - chunk.walls.first;
+                chunk.floor.first = (unsigned int)floorIndices.size();
+                bakeFloor(layout, x0, z0, x1, z1, floorVertices, floorIndices);
+                chunk.floor.count = (unsigned int)floorIndices.size() - chunk.floor.first;
+                chunks.push_back(chunk);
+            }
+        }
+        upload(walls, wallVertices, wallIndices);
+        upload(floor, floorVertices, floorIndices);
+    }
+
+    void DrawWalls() const { draw(walls); }
+    void DrawFloor() const { draw(floor); }
+
+    // only the chunks intersecting the frustum, counted in stats per non-empty chunk. visibleChunks
+    // optionally limits the draw to a bitset of chunks, e.g. a potentially visible set
+    void DrawWalls(const Frustum& frustum, CullStats* stats = nullptr, const uint64_t* visibleChunks = nullptr) const { draw(walls, &Chunk::walls, frustum, stats, visibleChunks); }
+    void DrawFloor(const Frustum& frustum, CullStats* stats = nullptr, const uint64_t* visibleChunks = nullptr) const { draw(floor, &Chunk::floor, frustum, stats, visibleChunks); }
+
+    // queues the same culled ranges as a single multi draw item; item carries program, texture and
+    // model uniform, the ranges stay valid until the next submit or draw of the batch
+    void SubmitWalls(RenderQueue& queue, RenderQueue::DrawItem item, const Frustum& frustum, CullStats* stats = nullptr, const uint64_t* visibleChunks = nullptr) const { submit(queue, item, walls, &Chunk::walls, frustum, stats, visibleChunks); }
+    void SubmitFloor(RenderQueue& queue, RenderQueue::DrawItem item, const Frustum& frustum, CullStats* stats = nullptr, const uint64_t* visibleChunks = nullptr) const { submit(queue, item, floor, &Chunk::floor, frustum, stats, visibleChunks); }
+
+    // chunk holding tile (x, z), the index into chunks
+    int ChunkIndex(int x, int z) const { return (z / CHUNK_TILES) * chunksX + x / CHUNK_TILES; }
+
+    void Release()
+    {
+        release(walls);
+        release(floor);
+        chunks.clear();
+    }
+
+private:
+    float tile = 1.0f;
+    int width = 0;
+    int height = 0;
+    int chunksX = 0;
+
+    // walls of the tiles in [x0, x1) x [z0, z1)
+    // ------------------------------------------------------------------------
+    void bakeWalls(const std::vector<std::string>& layout, int x0, int z0, int x1, int z1, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+    {
+        bakeWallSides(layout, x0, z0, x1, z1, vertices, indices);
+        std::vector<char> blockMask((x1 - x0) * (z1 - z0), 0);
+        for (int z = z0; z < z1; z++)
+            for (int x = x0; x < x1; x++)
+                blockMask[(z - z0) * (x1 - x0) + x - x0] = isBlock(layout, x, z);
+        mergeRects(blockMask, x1 - x0, z1 - z0, [&](int x, int z, int w, int h)
+        {
+            glm::vec3 origin((x0 + x) * tile - tile * 0.5f, WALL_HEIGHT, (z0 + z) * tile - tile * 0.5f);
+            addQuad(vertices, indices, origin, glm::vec3(w * tile, 0, 0), glm::vec3(0, 0, h * tile), glm::vec3(0, 1, 0), glm::vec2(w, h));
+        });
+        for (int z = z0; z < z1; z++)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                char t = tileAt(layout, x, z);
+                glm::vec3 center(x * tile, WALL_HEIGHT * 0.5f, z * tile);
+                if (t == '-')
+                    addBox(vertices, indices, center, glm::vec3(tile * 0.5f, WALL_HEIGHT * 0.5f, THIN_WALL_DEPTH * 0.5f));
+                else if (t == '|')
+                    addBox(vertices, indices, center, glm::vec3(THIN_WALL_DEPTH * 0.5f, WALL_HEIGHT * 0.5f, tile * 0.5f));
+            }
+        }
+    }
+
+    // floor: only the top face of tiles not covered by a solid block
+    // ------------------------------------------------------------------------
+    void bakeFloor(const std::vector<std::string>& layout, int x0, int z0, int x1, int z1, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+    {
+        std::vector<char> floorMask((x1 - x0) * (z1 - z0), 0);
+        for (int z = z0; z < z1; z++)
+            for (int x = x0; x < x1; x++)
+                floorMask[(z - z0) * (x1 - x0) + x - x0] = !isBlock(layout, x, z);
+        mergeRects(floorMask, x1 - x0, z1 - z0, [&](int x, int z, int w, int h)
+        {
+            glm::vec3 origin((x0 + x) * tile - tile * 0.5f, 0.0f, (z0 + z) * tile - tile * 0.5f);
+            addQuad(vertices, indices, origin, glm::vec3(w * tile, 0, 0), glm::vec3(0, 0, h * tile), glm::vec3(0, 1, 0), glm::vec2(w, h));
+        });
+    }
+
+    char tileAt(const std::vector<std::string>& layout, int x, int z) const
+    {
+        if (z < 0 || z >= (int)layout.size() || x < 0 || x >= (int)layout[z].size())
+            return '#'; // outside the map counts as solid so border faces are culled
+        return layout[z][x];
+    }
+
+    bool isBlock(const std::vector<std::string>& layout, int x, int z) const
+    {
+        return tileAt(layout, x, z) == '#';
+    }
+
+    // emits the side faces of '#' blocks in [x0, x1) x [z0, z1) that face a non-block tile,
+    // merged into vertical strips
+    // ------------------------------------------------------------------------
+    void bakeWallSides(const std::vector<std::string>& layout, int x0, int z0, int x1, int z1, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+    {
+        const glm::vec3 up(0.0f, WALL_HEIGHT, 0.0f);
+        const float half = tile * 0.5f;
+
+        // faces pointing along -x / +x, strips run along z
+        for (int side = -1; side <= 1; side += 2)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                int z = z0;
+                while (z < z1)
+                {
+                    if (!isBlock(layout, x, z) || isBlock(layout, x + side, z)) { z++; continue; }
+                    int start = z;
+                    while (z < z1 && isBlock(layout, x, z) && !isBlock(layout, x + side, z)) z++;
+                    glm::vec3 origin(x * tile + side * half, 0.0f, start * tile - half);
+                    addQuad(vertices, indices, origin, glm::vec3(0, 0, (z - start) * tile), up, glm::vec3(side, 0, 0), glm::vec2(z - start, 1));
+                }
+            }
+        }
+        // faces pointing along -z / +z, strips run along x
+        for (int side = -1; side <= 1; side += 2)
+        {
+            for (int z = z0; z < z1; z++)
+            {
+                int x = x0;
+                while (x < x1)
+                {
+                    if (!isBlock(layout, x, z) || isBlock(layout, x, z + side)) { x++; continue; }
+                    int start = x;
+                    while (x < x1 && isBlock(layout, x, z) && !isBlock(layout, x, z + side)) x++;
+                    glm::vec3 origin(start * tile - half, 0.0f, z * tile + side * half);
+                    addQuad(vertices, indices, origin, glm::vec3((x - start) * tile, 0, 0), up, glm::vec3(0, 0, side), glm::vec2(x - start, 1));
+                }
+            }
+        }
+    }
+
+    // greedy rectangle merge over a width x height mask, calls emit(x, z, w, h) per rectangle
+    // ------------------------------------------------------------------------
+    template <typename Emit>
+    static void mergeRects(std::vector<char>& mask, int width, int height, Emit emit)
+    {
+        for (int z = 0; z < height; z++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                if (!mask[z * width + x]) continue;
+                int w = 1;
+                while (x + w < width && mask[z * width + x + w]) w++;
+                int h = 1;
+                bool grow = true;
+                while (grow && z + h < height)
+                {
+                    for (int i = 0; i < w; i++)
+                        if (!mask[(z + h) * width + x + i]) { grow = false; break; }
+                    if (grow) h++;
+                }
+                for (int j = 0; j < h; j++)
+                    for (int i = 0; i < w; i++)
+                        mask[(z + j) * width + x + i] = 0;
+                emit(x, z, w, h);
+            }
+        }
+    }
+
+    // thin walls are too few to be worth merging, emit them as boxes without a bottom face
+    // ------------------------------------------------------------------------
+    void addBox(std::vector<float>& vertices, std::vector<unsigned int>& indices, glm::vec3 center, glm::vec3 halfExtents)
+    {
+        glm::vec3 e = halfExtents;
+        glm::vec3 dx(2 * e.x, 0, 0), dy(0, 2 * e.y, 0), dz(0, 0, 2 * e.z);
+        glm::vec3 min = center - e;
+        glm::vec3 max = center + e;
+        addQuad(vertices, indices, min, dz, dy, glm::vec3(-1, 0, 0), glm::vec2(1));
+        addQuad(vertices, indices, glm::vec3(max.x, min.y, min.z), dz, dy, glm::vec3(1, 0, 0), glm::vec2(1));
+        addQuad(vertices, indices, min, dx, dy, glm::vec3(0, 0, -1), glm::vec2(1));
+        addQuad(vertices, indices, glm::vec3(min.x, min.y, max.z), dx, dy, glm::vec3(0, 0, 1), glm::vec2(1));
+        addQuad(vertices, indices, glm::vec3(min.x, max.y, min.z), dx, dz, glm::vec3(0, 1, 0), glm::vec2(1));
+    }
+
+    // appends the quad origin, origin + u, origin + u + v, origin + v wound to face 'normal'.
+    // texcoords span uvScale so the (repeating) texture tiles once per map tile as before.
+    // ------------------------------------------------------------------------
+    void addQuad(std::vector<float>& vertices, std::vector<unsigned int>& indices, glm::vec3 origin, glm::vec3 u, glm::vec3 v, glm::vec3 normal, glm::vec2 uvScale)
+    {
+        unsigned int base = (unsigned int)(vertices.size() / 8);
+        glm::vec3 corners[4] = { origin, origin + u, origin + u + v, origin + v };
+        glm::vec2 uvs[4] = { glm::vec2(0.0f), glm::vec2(uvScale.x, 0.0f), uvScale, glm::vec2(0.0f, uvScale.y) };
+        for (int i = 0; i < 4; i++)
+        {
+            vertices.insert(vertices.end(), { corners[i].x, corners[i].y, corners[i].z, normal.x, normal.y, normal.z, uvs[i].x, uvs[i].y });
+        }
+        if (glm::dot(glm::cross(u, v), normal) >= 0.0f)
+            indices.insert(indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
+        else
+            indices.insert(indices.end(), { base, base + 2, base + 1, base, base + 3, base + 2 });
+    }
+
+    void upload(Batch& batch, const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+    {
+        batch.indexCount = (unsigned int)indices.size();
+        glGenVertexArrays(1, &batch.VAO);
+        glGenBuffers(1, &batch.VBO);
+        glGenBuffers(1, &batch.EBO);
+        glBindVertexArray(batch.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, batch.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2); glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindVertexArray(0);
+    }
+
+    void draw(const Batch& batch) const
+    {
+        if (batch.indexCount == 0) return;
+        glBindVertexArray(batch.VAO);
+        glDrawElements(GL_TRIANGLES, batch.indexCount, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+    }
+
+    // gathers the visible chunk ranges into the batch, neighbours in storage order joined into one
+    // range; false when nothing is visible
+    bool collect(const Batch& batch, Range Chunk::*range, const Frustum& frustum, CullStats* stats, const uint64_t* visibleChunks) const
+    {
+        std::vector<GLsizei>& drawCounts = batch.drawCounts;
+        std::vector<const void*>& drawOffsets = batch.drawOffsets;
+        drawCounts.clear();
+        drawOffsets.clear();
+        if (batch.indexCount == 0) return false;
+        unsigned int end = 0;
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            const Chunk& chunk = chunks[i];
+            const Range& r = chunk.*range;
+            if (r.count == 0) continue;
+            if (visibleChunks && !(visibleChunks[i / 64] >> (i % 64) & 1))
+            {
+                if (stats) stats->occluded++;
+                continue;
+            }
+            bool visible = frustum.Intersects(chunk.bounds);
+            if (stats) stats->Record(visible);
+            if (!visible) continue;
+            if (!drawCounts.empty() && r.first == end)
+                drawCounts.back() += r.count;
+            else
+            {
+                drawCounts.push_back((GLsizei)r.count);
+                drawOffsets.push_back((const void*)(r.first * sizeof(unsigned int)));
+            }
+            end = r.first + r.count;
+        }
+        return !drawCounts.empty();
+    }
+
+    void draw(const Batch& batch, Range Chunk::*range, const Frustum& frustum, CullStats* stats, const uint64_t* visibleChunks) const
+    {
+        if (!collect(batch, range, frustum, stats, visibleChunks)) return;
+        glBindVertexArray(batch.VAO);
+        glMultiDrawElements(GL_TRIANGLES, batch.drawCounts.data(), GL_UNSIGNED_INT, batch.drawOffsets.data(), (GLsizei)batch.drawCounts.size());
+        glBindVertexArray(0);
+    }
+
+    // the level is the nearest occluder almost everywhere, so it goes in at depth 0
+    void submit(RenderQueue& queue, RenderQueue::DrawItem item, const Batch& batch, Range Chunk::*range, const Frustum& frustum, CullStats* stats, const uint64_t* visibleChunks) const
+    {
+        if (!collect(batch, range, frustum, stats, visibleChunks)) return;
+        item.vertexArray = batch.VAO;
+        item.mode = GL_TRIANGLES;
+        item.indexType = GL_UNSIGNED_INT;
+        item.multiCounts = batch.drawCounts.data();
+        item.multiOffsets = batch.drawOffsets.data();
+        item.multiDrawCount = (GLsizei)batch.drawCounts.size();
+        queue.Submit(0.0f, item);
+    }
+
+    void release(Batch& batch)
+    {
+        if (batch.VAO) glDeleteVertexArrays(1, &batch.VAO);
+        if (batch.VBO) glDeleteBuffers(1, &batch.VBO);
+        if (batch.EBO) glDeleteBuffers(1, &batch.EBO);
+        batch = Batch();
+    }
+};
+#endif
@@ -0,0 +1,239 @@
+#ifndef LEVEL_VISIBILITY_H
+#define LEVEL_VISIBILITY_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/level_mesh.h>
+#include <learnopengl/thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Potentially visible sets of a level grid, baked once after LevelMesh. Walls are taller than
+// anything can jump, so visibility is solved in the grid plane: from sample points spread over the
+// floor tiles of every CLUSTER_TILES x CLUSTER_TILES cluster, RAYS_PER_SAMPLE rays are marched
+// until they hit a '#' block, every tile they cross is visible. The result is grown by one tile
+// to cover positions between samples, then stored per cluster as three bitsets:
+//   tiles    every grid tile, for dynamic objects (the hunter)
+//   chunks   LevelMesh chunks holding a visible tile, fed to its culled draws
+//   barrels  barrels standing on a visible tile
+// Destroyed barrels are cleared from a separate alive set, so the per cluster sets never change.
+// Positions outside the grid or in a cluster without floor fall back to "everything visible".
+class LevelVisibility
+{
+public:
+    static constexpr int CLUSTER_TILES = 2;
+    static constexpr int RAYS_PER_SAMPLE = 1024;
+
+    // barrels are the world positions of the barrels, in the order used for SetBarrelAlive()
+    void Bake(const std::vector<std::string>& layout, float tileSize, const LevelMesh& mesh, const std::vector<glm::vec3>& barrels, ThreadPool* pool = nullptr)
+    {
+        tile = tileSize;
+        height = (int)layout.size();
+        width = 0;
+        for (const std::string& row : layout)
+            width = std::max(width, (int)row.size());
+        clustersX = (width + CLUSTER_TILES - 1) / CLUSTER_TILES;
+        clustersZ = (height + CLUSTER_TILES - 1) / CLUSTER_TILES;
+        int clusterCount = clustersX * clustersZ;
+        tileWords = words(width * height);
+        chunkWords = words((int)mesh.chunks.size());
+        barrelWords = words((int)barrels.size());
+        tileBits.assign((size_t)clusterCount * tileWords, 0);
+        chunkBits.assign((size_t)clusterCount * chunkWords, 0);
+        barrelBits.assign((size_t)clusterCount * barrelWords, 0);
+        baked.assign(clusterCount, 0);
+        solid.assign(width * height, 1);
+        for (int z = 0; z < height; z++)
+            for (int x = 0; x < (int)layout[z].size(); x++)
+                solid[z * width + x] = layout[z][x] == '#';
+        barrelTiles.clear();
+        for (const glm::vec3& position : barrels)
+            barrelTiles.push_back(tileIndex(position));
+        ResetBarrels();
+
+        auto bakeCluster = [&](int cluster) { bake(cluster, mesh); };
+        if (pool)
+            pool->ParallelFor(clusterCount, bakeCluster);
+        else
+            for (int cluster = 0; cluster < clusterCount; cluster++)
+                bakeCluster(cluster);
+        solid.clear();
+    }
+
+    // cluster the position lies in, -1 when there is no set for it
+    int ClusterAt(const glm::vec3& position) const
+    {
+        int index = tileIndex(position);
+        if (index < 0) return -1;
+        int cluster = ((index / width) / CLUSTER_TILES) * clustersX + (index % width) / CLUSTER_TILES;
+        return baked[cluster] ? cluster : -1;
+    }
+
+    // LevelMesh chunk mask of a cluster, nullptr (draw all) for -1
+    const uint64_t* ChunkBits(int cluster) const
+    {
+        return cluster < 0 || chunkWords == 0 ? nullptr : &chunkBits[(size_t)cluster * chunkWords];
+    }
+
+    bool TileVisible(int cluster, const glm::vec3& position) const
+    {
+        int index = tileIndex(position);
+        if (cluster < 0 || index < 0) return true;
+        return testBit(&tileBits[(size_t)cluster * tileWords], index);
+    }
+
+    // calls f(index) for every barrel that is alive and potentially visible from the cluster
+    template <typename F>
+    void ForEachVisibleBarrel(int cluster, F f) const
+    {
+        for (int w = 0; w < barrelWords; w++)
+        {
+            uint64_t bits = aliveBarrels[w];
+            if (cluster >= 0) bits &= barrelBits[(size_t)cluster * barrelWords + w];
+            while (bits)
+            {
+                int bit = 0;
+                while (!(bits >> bit & 1)) bit++;
+                bits &= bits - 1;
+                f(w * 64 + bit);
+            }
+        }
+    }
+
+    void SetBarrelAlive(int index, bool alive)
+    {
+        uint64_t mask = 1ull << (index % 64);
+        if (alive) aliveBarrels[index / 64] |= mask;
+        else aliveBarrels[index / 64] &= ~mask;
+    }
+
+    void ResetBarrels()
+    {
+        aliveBarrels.assign(barrelWords, 0);
+        for (int i = 0; i < (int)barrelTiles.size(); i++)
+            SetBarrelAlive(i, true);
+    }
+
+    int ClusterCount() const { return clustersX * clustersZ; }
+
+    size_t ByteSize() const { return (tileBits.size() + chunkBits.size() + barrelBits.size()) * sizeof(uint64_t); }
+
+    // visible chunks of a cluster, to report the bake
+    int VisibleChunks(int cluster) const
+    {
+        int count = 0;
+        for (int w = 0; w < chunkWords; w++)
+            for (uint64_t bits = chunkBits[(size_t)cluster * chunkWords + w]; bits; bits &= bits - 1)
+                count++;
+        return count;
+    }
+
+    bool Baked(int cluster) const { return baked[cluster] != 0; }
+
+private:
+    float tile = 1.0f;
+    int width = 0;
+    int height = 0;
+    int clustersX = 0;
+    int clustersZ = 0;
+    int tileWords = 0;
+    int chunkWords = 0;
+    int barrelWords = 0;
+    std::vector<uint64_t> tileBits;   // per cluster, tileWords each
+    std::vector<uint64_t> chunkBits;  // per cluster, chunkWords each
+    std::vector<uint64_t> barrelBits; // per cluster, barrelWords each
+    std::vector<uint64_t> aliveBarrels;
+    std::vector<char> baked;          // cluster has floor tiles and a set
+    std::vector<char> solid;          // '#' per tile, only during Bake()
+    std::vector<int> barrelTiles;
+
+    static int words(int bits) { return (bits + 63) / 64; }
+    static bool testBit(const uint64_t* bits, int index) { return bits[index / 64] >> (index % 64) & 1; }
+    static void setBit(uint64_t* bits, int index) { bits[index / 64] |= 1ull << (index % 64); }
+
+    // tiles are centered on multiples of the tile size, like LevelMesh
+    int tileIndex(const glm::vec3& position) const
+    {
+        int x = (int)std::floor(position.x / tile + 0.5f);
+        int z = (int)std::floor(position.z / tile + 0.5f);
+        if (x < 0 || x >= width || z < 0 || z >= height) return -1;
+        return z * width + x;
+    }
+
+    void bake(int cluster, const LevelMesh& mesh)
+    {
+        int cx = cluster % clustersX * CLUSTER_TILES;
+        int cz = cluster / clustersX * CLUSTER_TILES;
+        std::vector<char> visible(width * height, 0);
+        bool hasFloor = false;
+        for (int z = cz; z < std::min(cz + CLUSTER_TILES, height); z++)
+        {
+            for (int x = cx; x < std::min(cx + CLUSTER_TILES, width); x++)
+            {
+                if (solid[z * width + x]) continue;
+                hasFloor = true;
+                // center and corners, pulled in so the rays do not start on a wall edge
+                const float inset = 0.4f;
+                const glm::vec2 offsets[5] = { glm::vec2(0.0f), glm::vec2(-inset, -inset), glm::vec2(inset, -inset), glm::vec2(-inset, inset), glm::vec2(inset, inset) };
+                for (const glm::vec2& offset : offsets)
+                    castRays(glm::vec2(x, z) + offset, visible);
+            }
+        }
+        if (!hasFloor) return;
+
+        uint64_t* tiles = &tileBits[(size_t)cluster * tileWords];
+        uint64_t* chunks = &chunkBits[(size_t)cluster * chunkWords];
+        for (int z = 0; z < height; z++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                bool near = false;
+                for (int dz = -1; dz <= 1 && !near; dz++)
+                    for (int dx = -1; dx <= 1 && !near; dx++)
+                    {
+                        int nx = x + dx, nz = z + dz;
+                        near = nx >= 0 && nx < width && nz >= 0 && nz < height && visible[nz * width + nx];
+                    }
+                if (!near) continue;
+                setBit(tiles, z * width + x);
+                setBit(chunks, mesh.ChunkIndex(x, z));
+            }
+        }
+        uint64_t* barrels = &barrelBits[(size_t)cluster * barrelWords];
+        for (int i = 0; i < (int)barrelTiles.size(); i++)
+            if (barrelTiles[i] < 0 || testBit(tiles, barrelTiles[i]))
+                setBit(barrels, i);
+        baked[cluster] = 1;
+    }
+
+    // grid traversal (Amanatides & Woo) in tile units, tile (x, z) covering [x - 0.5, x + 0.5)
+    void castRays(glm::vec2 origin, std::vector<char>& visible) const
+    {
+        glm::vec2 start = origin + glm::vec2(0.5f);
+        for (int r = 0; r < RAYS_PER_SAMPLE; r++)
+        {
+            float angle = 6.28318530718f * (r + 0.5f) / RAYS_PER_SAMPLE;
+            glm::vec2 direction(std::cos(angle), std::sin(angle));
+            int x = (int)std::floor(start.x);
+            int z = (int)std::floor(start.y);
+            int stepX = direction.x >= 0.0f ? 1 : -1;
+            int stepZ = direction.y >= 0.0f ? 1 : -1;
+            float deltaX = direction.x != 0.0f ? std::abs(1.0f / direction.x) : 1e30f;
+            float deltaZ = direction.y != 0.0f ? std::abs(1.0f / direction.y) : 1e30f;
+            float nextX = (stepX > 0 ? x + 1 - start.x : start.x - x) * deltaX;
+            float nextZ = (stepZ > 0 ? z + 1 - start.y : start.y - z) * deltaZ;
+            while (x >= 0 && x < width && z >= 0 && z < height)
+            {
+                visible[z * width + x] = 1;
+                if (solid[z * width + x]) break;
+                if (nextX < nextZ) { x += stepX; nextX += deltaX; }
+                else { z += stepZ; nextZ += deltaZ; }
+            }
+        }
+    }
+};
+#endif
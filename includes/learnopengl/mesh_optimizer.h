@@ -0,0 +1,335 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// Before/after numbers for one or more optimized meshes. ACMR (average cache miss ratio) is the
+// number of vertex shader invocations per triangle on a simulated FIFO post-transform cache:
+// 3.0 means nothing is reused, ~0.6-0.7 is close to the best a regular mesh can get.
+struct MeshOptimizationStats
+{
+    size_t triangles = 0;
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+    size_t missesBefore = 0;
+    size_t missesAfter = 0;
+
+    float AcmrBefore() const { return triangles ? (float)missesBefore / triangles : 0.0f; }
+    float AcmrAfter() const { return triangles ? (float)missesAfter / triangles : 0.0f; }
+
+    void Add(const MeshOptimizationStats& other)
+    {
+        triangles += other.triangles;
+        verticesBefore += other.verticesBefore;
+        verticesAfter += other.verticesAfter;
+        missesBefore += other.missesBefore;
+        missesAfter += other.missesAfter;
+    }
+};
+
+// Import-time optimization of an indexed triangle list, run in this order by Optimize():
+//   1. weld    - merge vertices that are bitwise identical (Assimp emits one per face corner)
+//   2. cache   - reorder triangles for post-transform cache reuse (Tipsify, Sander et al. 2007)
+//   3. overdraw- split the cache-ordered list into clusters and draw outward facing ones first,
+//                giving up at most OVERDRAW_THRESHOLD of the ACMR gained in step 2
+//   4. fetch   - renumber vertices in first-use order so vertex fetch walks memory linearly
+struct MeshOptimizer
+{
+    static constexpr int CACHE_SIZE = 16;
+    static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+    static MeshOptimizationStats Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        MeshOptimizationStats stats;
+        stats.triangles = indices.size() / 3;
+        stats.verticesBefore = vertices.size();
+        stats.missesBefore = CacheMisses(indices, vertices.size());
+
+        if (indices.size() >= 3)
+        {
+            WeldVertices(vertices, indices);
+            OptimizeVertexCache(indices, vertices.size());
+            OptimizeOverdraw(indices, vertices);
+            OptimizeVertexFetch(vertices, indices);
+        }
+
+        stats.verticesAfter = vertices.size();
+        stats.missesAfter = CacheMisses(indices, vertices.size());
+        return stats;
+    }
+
+    // vertices are compared byte for byte, so only exact duplicates (including bone data) merge
+    static void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        struct Hash
+        {
+            const Vertex* data;
+            size_t operator()(unsigned int i) const
+            {
+                // FNV-1a over the raw vertex
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&data[i]);
+                uint64_t h = 14695981039346656037ull;
+                for (size_t b = 0; b < sizeof(Vertex); b++)
+                    h = (h ^ bytes[b]) * 1099511628211ull;
+                return (size_t)h;
+            }
+        };
+        struct Equal
+        {
+            const Vertex* data;
+            bool operator()(unsigned int a, unsigned int b) const
+            {
+                return std::memcmp(&data[a], &data[b], sizeof(Vertex)) == 0;
+            }
+        };
+
+        std::unordered_map<unsigned int, unsigned int, Hash, Equal> unique(vertices.size(), Hash{vertices.data()}, Equal{vertices.data()});
+        std::vector<unsigned int> remap(vertices.size());
+        std::vector<Vertex> welded;
+        welded.reserve(vertices.size());
+        for (unsigned int i = 0; i < vertices.size(); i++)
+        {
+            auto it = unique.emplace(i, (unsigned int)welded.size());
+            if (it.second) welded.push_back(vertices[i]);
+            remap[i] = it.first->second;
+        }
+        if (welded.size() == vertices.size()) return;
+
+        for (unsigned int& index : indices)
+            index = remap[index];
+        vertices.swap(welded);
+    }
+
+    static void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        // vertex -> triangle adjacency in CSR form, plus the number of not yet emitted triangles
+        std::vector<unsigned int> live(vertexCount, 0);
+        for (unsigned int index : indices)
+            live[index]++;
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] = offsets[v] + live[v];
+        std::vector<unsigned int> adjacency(indices.size());
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+        std::vector<unsigned int> timestamps(vertexCount, 0);
+        std::vector<char> emitted(triangleCount, 0);
+        std::vector<unsigned int> deadEnd;
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> result;
+        deadEnd.reserve(indices.size());
+        result.reserve(indices.size());
+
+        unsigned int time = CACHE_SIZE + 1;
+        size_t cursor = 0;
+        unsigned int fan = NextLive(live, cursor);
+        while (fan != ~0u)
+        {
+            // emit every remaining triangle around the fanning vertex
+            candidates.clear();
+            for (unsigned int k = offsets[fan]; k < offsets[fan + 1]; k++)
+            {
+                unsigned int t = adjacency[k];
+                if (emitted[t]) continue;
+                for (int c = 0; c < 3; c++)
+                {
+                    unsigned int v = indices[t * 3 + c];
+                    result.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - timestamps[v] > (unsigned int)CACHE_SIZE)
+                        timestamps[v] = time++;
+                }
+                emitted[t] = 1;
+            }
+
+            // next fan: the candidate that will still be in the cache after its own triangles
+            // are emitted and that has been there longest, else the most recent dead end
+            unsigned int best = ~0u;
+            long bestPriority = -1;
+            for (unsigned int v : candidates)
+            {
+                if (live[v] == 0) continue;
+                long priority = 0;
+                if ((long)(time - timestamps[v]) + 2 * (long)live[v] <= CACHE_SIZE)
+                    priority = time - timestamps[v];
+                if (priority > bestPriority)
+                {
+                    best = v;
+                    bestPriority = priority;
+                }
+            }
+            while (best == ~0u && !deadEnd.empty())
+            {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) best = v;
+            }
+            if (best == ~0u)
+                best = NextLive(live, cursor);
+            fan = best;
+        }
+        indices.swap(result);
+    }
+
+    static void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold = OVERDRAW_THRESHOLD)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        // hard boundaries: triangles whose three vertices all miss the cache start a new cluster,
+        // moving those clusters around costs no cache efficiency
+        std::vector<size_t> hard;
+        {
+            FifoCache cache(vertices.size());
+            for (size_t t = 0; t < triangleCount; t++)
+            {
+                int misses = 0;
+                for (int c = 0; c < 3; c++)
+                    misses += cache.Access(indices[t * 3 + c]);
+                if (t == 0 || misses == 3) hard.push_back(t);
+            }
+            hard.push_back(triangleCount);
+        }
+
+        // soft boundaries: split hard clusters further wherever the prefix so far is already
+        // within threshold of the cluster's own ACMR
+        std::vector<size_t> clusters;
+        for (size_t h = 0; h + 1 < hard.size(); h++)
+        {
+            size_t begin = hard[h], end = hard[h + 1];
+            FifoCache whole(vertices.size());
+            size_t wholeMisses = 0;
+            for (size_t i = begin * 3; i < end * 3; i++)
+                wholeMisses += whole.Access(indices[i]);
+            float clusterAcmr = (float)wholeMisses / (end - begin);
+
+            FifoCache cache(vertices.size());
+            size_t start = begin, misses = 0;
+            clusters.push_back(begin);
+            for (size_t t = begin; t < end; t++)
+            {
+                for (int c = 0; c < 3; c++)
+                    misses += cache.Access(indices[t * 3 + c]);
+                size_t count = t + 1 - start;
+                if (t + 1 < end && count >= (size_t)CACHE_SIZE && (float)misses / count <= clusterAcmr * threshold)
+                {
+                    clusters.push_back(t + 1);
+                    start = t + 1;
+                    misses = 0;
+                    cache = FifoCache(vertices.size());
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+        size_t clusterCount = clusters.size() - 1;
+        if (clusterCount < 2) return;
+
+        // clusters facing away from the mesh centre are most likely to occlude the rest
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+        std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            float clusterArea = 0.0f;
+            for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                const glm::vec3& a = vertices[indices[t * 3 + 0]].Position;
+                const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+                const glm::vec3& d = vertices[indices[t * 3 + 2]].Position;
+                glm::vec3 normal = glm::cross(b - a, d - a);
+                float area = glm::length(normal);
+                glm::vec3 centre = (a + b + d) / 3.0f;
+                centroids[c] += centre * area;
+                normals[c] += normal;
+                clusterArea += area;
+            }
+            meshCentroid += centroids[c];
+            meshArea += clusterArea;
+            if (clusterArea > 0.0f) centroids[c] /= clusterArea;
+        }
+        if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+        std::vector<float> keys(clusterCount, 0.0f);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            float length = glm::length(normals[c]);
+            if (length > 0.0f)
+                keys[c] = glm::dot(centroids[c] - meshCentroid, normals[c] / length);
+        }
+        std::vector<size_t> order(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++) order[c] = c;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+        for (size_t c : order)
+            result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+        indices.swap(result);
+    }
+
+    // renumbers vertices in the order the index buffer first touches them, unreferenced ones are dropped
+    static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        std::vector<unsigned int> remap(vertices.size(), ~0u);
+        std::vector<Vertex> ordered;
+        ordered.reserve(vertices.size());
+        for (unsigned int& index : indices)
+        {
+            if (remap[index] == ~0u)
+            {
+                remap[index] = (unsigned int)ordered.size();
+                ordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices.swap(ordered);
+    }
+
+    static size_t CacheMisses(const std::vector<unsigned int>& indices, size_t vertexCount)
+    {
+        FifoCache cache(vertexCount);
+        size_t misses = 0;
+        for (unsigned int index : indices)
+            misses += cache.Access(index);
+        return misses;
+    }
+
+private:
+    // FIFO post-transform cache: a vertex stays resident for the next CACHE_SIZE - 1 misses
+    struct FifoCache
+    {
+        std::vector<unsigned int> stamps; // miss count at insertion, 0 = never loaded
+        unsigned int misses = 0;
+
+        explicit FifoCache(size_t vertexCount) : stamps(vertexCount, 0) {}
+
+        // returns 1 on a miss
+        int Access(unsigned int v)
+        {
+            if (stamps[v] != 0 && misses - stamps[v] < (unsigned int)CACHE_SIZE) return 0;
+            stamps[v] = ++misses;
+            return 1;
+        }
+    };
+
+    static unsigned int NextLive(const std::vector<unsigned int>& live, size_t& cursor)
+    {
+        while (cursor < live.size() && live[cursor] == 0) cursor++;
+        return cursor < live.size() ? (unsigned int)cursor : ~0u;
+    }
+};
+#endif
@@ -10,6 +10,16 @@
 #include <assimp/postprocess.h>
 
 #include <learnopengl/mesh.h>
+#include <learnopengl/packed_mesh.h>
+#include <learnopengl/mesh_optimizer.h>
+#include <learnopengl/baked_cache.h>
+#include <learnopengl/frustum.h>
+#include <learnopengl/instance_buffer.h>
+#include <learnopengl/render_queue.h>
+#include <learnopengl/import_cache.h>
+#include <learnopengl/texture_loader.h>
+#include <learnopengl/texture_registry.h>
+#include <learnopengl/thread_pool.h>
 #include <learnopengl/shader.h>
 #include <learnopengl/assimp_glm_helpers.h>
 #include <learnopengl/animdata.h>
@@ -18,7 +28,9 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <future>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -29,9 +41,13 @@ class Model
 {
 public:
     vector<Texture> textures_loaded;
-    vector<Mesh>    meshes;
+    vector<Mesh>    meshes;       // VertexFormat::Full
+    vector<PackedMesh> packedMeshes; // VertexFormat::Packed
     string directory;
     bool gammaCorrection;
+    VertexFormat vertexFormat;
+    MeshOptimizationStats optimizationStats; // summed over all meshes at import
+    BoundingBox bounds; // model space, bind pose for skinned meshes; set by Import()
 
     // Bone Data
     std::map<string, BoneInfo> m_BoneInfoMap;
@@ -40,29 +56,322 @@ public:
     auto& GetBoneInfoMap() { return m_BoneInfoMap; }
     int& GetBoneCount() { return m_BoneCounter; }
 
-    Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
+    Model(string const &path, bool gamma = false, VertexFormat format = VertexFormat::Packed) : gammaCorrection(gamma), vertexFormat(format)
     {
+        Import(path);
+        Upload();
+    }
+
+    // empty model to be filled by Import() + Upload(), e.g. from an AssetLoader
+    Model() : gammaCorrection(false), vertexFormat(VertexFormat::Packed) {}
+
+    // CPU half of loading: reads the bake or imports through Assimp, optimizes and packs the meshes
+    // and decodes their textures. Makes no GL calls, so it can run on a worker thread; with a
+    // decodePool every texture is decoded as a separate task on it.
+    void Import(string const &path, ThreadPool* decodePool = nullptr)
+    {
+        this->decodePool = decodePool;
         loadModel(path);
+        this->decodePool = nullptr;
+        computeBounds();
+    }
+
+    // GL half of loading, on the GL thread: creates the buffers and textures Import() prepared
+    void Upload(TextureUploader* uploader = nullptr)
+    {
+        TextureUploader direct(false);
+        if(!uploader) uploader = &direct;
+        for(unsigned int i = 0; i < pendingPackedTextures.size(); i++)
+        {
+            packedMeshes[i].textures = resolveTextures(pendingPackedTextures[i], *uploader);
+            packedMeshes[i].Upload();
+        }
+        for(PendingMesh& mesh : pendingMeshes)
+            meshes.push_back(Mesh(mesh.vertices, mesh.indices, resolveTextures(mesh.textures, *uploader)));
+        pendingMeshes.clear();
+        pendingPackedTextures.clear();
     }
 
     void Draw(Shader &shader)
     {
         for(unsigned int i = 0; i < meshes.size(); i++)
             meshes[i].Draw(shader);
+        for(unsigned int i = 0; i < packedMeshes.size(); i++)
+            packedMeshes[i].Draw(shader);
+    }
+
+    // adds the per-instance model matrix of instances to the vertex arrays of all meshes, used by
+    // DrawInstanced / SubmitInstanced with a shader reading it at InstanceBuffer::FIRST_LOCATION
+    void SetInstanceBuffer(const InstanceBuffer &instances)
+    {
+        for(unsigned int i = 0; i < meshes.size(); i++)
+            setInstanceAttributes(meshes[i].VAO, instances.VBO);
+        for(unsigned int i = 0; i < packedMeshes.size(); i++)
+            setInstanceAttributes(packedMeshes[i].VAO, instances.VBO);
+    }
+
+    // draws the first instanceCount instances of the SetInstanceBuffer() buffer, one call per mesh
+    void DrawInstanced(Shader &shader, GLsizei instanceCount)
+    {
+        if(instanceCount <= 0) return;
+        for(unsigned int i = 0; i < meshes.size(); i++)
+        {
+            PackedMesh::BindTextures(shader, meshes[i].textures);
+            glBindVertexArray(meshes[i].VAO);
+            glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)meshes[i].indices.size(), GL_UNSIGNED_INT, 0, instanceCount);
+        }
+        for(unsigned int i = 0; i < packedMeshes.size(); i++)
+        {
+            packedMeshes[i].BindTextures(shader);
+            glBindVertexArray(packedMeshes[i].VAO);
+            glDrawElementsInstanced(GL_TRIANGLES, packedMeshes[i].indexCount, packedMeshes[i].indexType, 0, instanceCount);
+        }
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // queues every mesh as an opaque item with the given program and model matrix. the item
+    // binds the mesh's first diffuse texture, or fallbackTexture for meshes without one
+    void Submit(RenderQueue &queue, unsigned int program, GLint modelLocation, const glm::mat4 &model, float depth, unsigned int fallbackTexture = 0)
+    {
+        RenderQueue::DrawItem item;
+        item.program = program;
+        item.modelLocation = modelLocation;
+        item.model = model;
+        submitMeshes(queue, item, depth, fallbackTexture);
+    }
+
+    // instanced counterpart of Submit(), one item per mesh for instanceCount instances
+    void SubmitInstanced(RenderQueue &queue, unsigned int program, GLsizei instanceCount, float depth, unsigned int fallbackTexture = 0)
+    {
+        if(instanceCount <= 0) return;
+        RenderQueue::DrawItem item;
+        item.program = program;
+        item.instanceCount = instanceCount;
+        submitMeshes(queue, item, depth, fallbackTexture);
     }
 
 private:
+    // one opaque item per mesh, item holds everything but the mesh
+    void submitMeshes(RenderQueue &queue, RenderQueue::DrawItem item, float depth, unsigned int fallbackTexture)
+    {
+        for(unsigned int i = 0; i < meshes.size(); i++)
+        {
+            item.texture = diffuseTexture(meshes[i].textures, fallbackTexture);
+            item.vertexArray = meshes[i].VAO;
+            item.count = (GLsizei)meshes[i].indices.size();
+            item.indexType = GL_UNSIGNED_INT;
+            queue.Submit(depth, item);
+        }
+        for(unsigned int i = 0; i < packedMeshes.size(); i++)
+        {
+            item.texture = diffuseTexture(packedMeshes[i].textures, fallbackTexture);
+            item.vertexArray = packedMeshes[i].VAO;
+            item.count = (GLsizei)packedMeshes[i].indexCount;
+            item.indexType = packedMeshes[i].indexType;
+            queue.Submit(depth, item);
+        }
+    }
+
+    // a mat4 attribute takes four vec4 locations, each advancing once per instance
+    static void setInstanceAttributes(unsigned int vertexArray, unsigned int instanceVBO)
+    {
+        glBindVertexArray(vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for(GLuint column = 0; column < 4; column++)
+        {
+            GLuint location = InstanceBuffer::FIRST_LOCATION + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    static unsigned int diffuseTexture(const vector<Texture> &textures, unsigned int fallback)
+    {
+        for(const Texture& texture : textures)
+            if(texture.type == "texture_diffuse")
+                return texture.id;
+        return fallback;
+    }
+
+    // texture a mesh asked for; resolved to a Texture once uploaded
+    struct TextureRef
+    {
+        string type;
+        string path;
+    };
+
+    // Full format mesh between Import() and Upload()
+    struct PendingMesh
+    {
+        vector<Vertex> vertices;
+        vector<unsigned int> indices;
+        vector<TextureRef> textures;
+    };
+
+    vector<PendingMesh> pendingMeshes;
+    vector<vector<TextureRef>> pendingPackedTextures; // parallel to packedMeshes
+    std::unordered_map<string, size_t> textureIndex; // material path -> textures_loaded slot
+    ThreadPool* decodePool = nullptr;
+
+    // starts decoding a texture (relative to the model directory) in the shared registry, which
+    // skips files that are already decoded or resident
+    void requestTexture(const string &path)
+    {
+        TextureRegistry::Shared().Prefetch(directory + '/' + path, decodePool);
+    }
+
+    vector<Texture> resolveTextures(const vector<TextureRef> &refs, TextureUploader &uploader)
+    {
+        vector<Texture> textures;
+        for(const TextureRef& ref : refs)
+            textures.push_back(loadTexture(ref.path.c_str(), ref.type, uploader));
+        return textures;
+    }
+
+    void computeBounds()
+    {
+        bounds = BoundingBox();
+        for(const PackedMesh& mesh : packedMeshes)
+            bounds.Expand(mesh.Bounds());
+        for(const PendingMesh& mesh : pendingMeshes)
+            for(const Vertex& vertex : mesh.vertices)
+                bounds.Expand(vertex.Position);
+    }
+
     void loadModel(string const &path)
     {
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace);
+        directory = path.substr(0, path.find_last_of('/'));
+        // the bake stores GPU-ready packed meshes, so only the packed format can use it
+        if(vertexFormat == VertexFormat::Packed && loadBaked(path))
+            return;
+
+        ImportCache::Scene imported = ImportCache::Shared().Get(path, ImportCache::FULL);
+        const aiScene* scene = imported.scene;
         if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
-            cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
+            cout << "ERROR::ASSIMP:: " << imported.error << endl;
             return;
         }
-        directory = path.substr(0, path.find_last_of('/'));
         processNode(scene->mRootNode, scene);
+        cout << "MODEL::OPTIMIZE " << path << ": " << optimizationStats.triangles << " triangles, vertices "
+             << optimizationStats.verticesBefore << " -> " << optimizationStats.verticesAfter << ", ACMR "
+             << optimizationStats.AcmrBefore() << " -> " << optimizationStats.AcmrAfter() << endl;
+        if(vertexFormat == VertexFormat::Packed && !saveBaked(path))
+            cout << "ERROR::MODEL::BAKE failed to write cache for " << path << endl;
+    }
+
+    // payload: bone counter, bone info map, optimization stats, then per mesh its packed layout,
+    // vertex and index bytes and (type, path) of every texture
+    bool saveBaked(string const &path)
+    {
+        BakedCache::Writer writer(path, BakedCache::MODEL, 0);
+        writer.Write((int32_t)m_BoneCounter);
+        writer.Write((uint32_t)m_BoneInfoMap.size());
+        for(const auto& entry : m_BoneInfoMap)
+        {
+            writer.WriteString(entry.first);
+            writer.Write((int32_t)entry.second.id);
+            writer.Write(entry.second.offset);
+        }
+        writer.Write(optimizationStats);
+        writer.Write((uint32_t)packedMeshes.size());
+        for(unsigned int i = 0; i < packedMeshes.size(); i++)
+        {
+            const PackedMesh& mesh = packedMeshes[i];
+            writer.Write((int32_t)mesh.layout);
+            writer.Write((uint32_t)mesh.vertexCount);
+            writer.Write((uint32_t)mesh.indexCount);
+            writer.Write((uint32_t)mesh.indexType);
+            writer.WriteVector(mesh.vertexData);
+            writer.WriteVector(mesh.indexData);
+            writer.Write((uint32_t)pendingPackedTextures[i].size());
+            for(const TextureRef& texture : pendingPackedTextures[i])
+            {
+                writer.WriteString(texture.type);
+                writer.WriteString(texture.path);
+            }
+        }
+        return writer.Commit();
+    }
+
+    bool loadBaked(string const &path)
+    {
+        BakedCache::Reader reader(path, BakedCache::MODEL, 0);
+        if(!reader.Valid())
+            return false;
+
+        int32_t boneCounter = 0;
+        uint32_t boneCount = 0;
+        std::map<string, BoneInfo> boneInfoMap;
+        reader.Read(boneCounter);
+        reader.Read(boneCount);
+        for(uint32_t i = 0; i < boneCount && reader.Valid(); i++)
+        {
+            string name;
+            int32_t id = 0;
+            BoneInfo info;
+            reader.ReadString(name);
+            reader.Read(id);
+            reader.Read(info.offset);
+            info.id = id;
+            boneInfoMap[name] = info;
+        }
+        MeshOptimizationStats stats;
+        uint32_t meshCount = 0;
+        reader.Read(stats);
+        reader.Read(meshCount);
+
+        // read everything first so a corrupt file leaves the model empty for the Assimp fallback
+        struct BakedMesh
+        {
+            int32_t layout = 0;
+            uint32_t vertexCount = 0, indexCount = 0, indexType = 0;
+            vector<unsigned char> vertexData, indexData;
+            vector<TextureRef> textures;
+        };
+        vector<BakedMesh> baked;
+        for(uint32_t i = 0; i < meshCount && reader.Valid(); i++)
+        {
+            BakedMesh mesh;
+            uint32_t textureCount = 0;
+            reader.Read(mesh.layout);
+            reader.Read(mesh.vertexCount);
+            reader.Read(mesh.indexCount);
+            reader.Read(mesh.indexType);
+            reader.ReadVector(mesh.vertexData);
+            reader.ReadVector(mesh.indexData);
+            reader.Read(textureCount);
+            for(uint32_t t = 0; t < textureCount && reader.Valid(); t++)
+            {
+                TextureRef texture;
+                reader.ReadString(texture.type);
+                reader.ReadString(texture.path);
+                mesh.textures.push_back(texture);
+            }
+            baked.push_back(std::move(mesh));
+        }
+        if(!reader.Valid())
+        {
+            cout << "ERROR::MODEL::BAKE corrupt cache for " << path << ", reimporting" << endl;
+            return false;
+        }
+
+        m_BoneCounter = boneCounter;
+        m_BoneInfoMap = std::move(boneInfoMap);
+        optimizationStats = stats;
+        for(BakedMesh& mesh : baked)
+        {
+            for(const TextureRef& texture : mesh.textures)
+                requestTexture(texture.path);
+            packedMeshes.push_back(PackedMesh((PackedMesh::Layout)mesh.layout, std::move(mesh.vertexData), mesh.vertexCount,
+                                              std::move(mesh.indexData), mesh.indexCount, (GLenum)mesh.indexType, {}, false));
+            pendingPackedTextures.push_back(std::move(mesh.textures));
+        }
+        return true;
     }
 
     void processNode(aiNode *node, const aiScene *scene)
@@ -70,7 +379,7 @@ private:
         for(unsigned int i = 0; i < node->mNumMeshes; i++)
         {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
+            processMesh(mesh, scene);
         }
         for(unsigned int i = 0; i < node->mNumChildren; i++)
         {
@@ -87,11 +396,11 @@ private:
         }
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    void processMesh(aiMesh *mesh, const aiScene *scene)
     {
         vector<Vertex> vertices;
         vector<unsigned int> indices;
-        vector<Texture> textures;
+        vector<TextureRef> textures;
 
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
@@ -99,6 +408,16 @@ private:
             SetVertexBoneDataToDefault(vertex);
             vertex.Position = AssimpGLMHelpers::GetGLMVec(mesh->mVertices[i]);
             vertex.Normal = AssimpGLMHelpers::GetGLMVec(mesh->mNormals[i]);
+            if(mesh->mTangents && mesh->mBitangents)
+            {
+                vertex.Tangent = AssimpGLMHelpers::GetGLMVec(mesh->mTangents[i]);
+                vertex.Bitangent = AssimpGLMHelpers::GetGLMVec(mesh->mBitangents[i]);
+            }
+            else
+            {
+                vertex.Tangent = glm::vec3(0.0f);
+                vertex.Bitangent = glm::vec3(0.0f);
+            }
 
             if(mesh->mTextureCoords[0])
             {
@@ -121,18 +440,27 @@ private:
         }
 
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
+        vector<TextureRef> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
+        vector<TextureRef> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
+        std::vector<TextureRef> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
         textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
+        std::vector<TextureRef> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
         textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
 
         ExtractBoneWeightForVertices(vertices, mesh, scene);
 
-        return Mesh(vertices, indices, textures);
+        // weld, cache/overdraw/fetch ordering; has to follow bone extraction, which indexes Assimp's vertices
+        optimizationStats.Add(MeshOptimizer::Optimize(vertices, indices));
+
+        if(vertexFormat == VertexFormat::Packed)
+        {
+            packedMeshes.push_back(PackedMesh(vertices, indices, {}, mesh->mNumBones > 0, false));
+            pendingPackedTextures.push_back(textures);
+        }
+        else
+            pendingMeshes.push_back(PendingMesh{ std::move(vertices), std::move(indices), textures });
     }
 
     void SetVertexBoneData(Vertex& vertex, int boneID, float weight)
@@ -181,71 +509,42 @@ private:
         }
     }
 
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+    vector<TextureRef> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
     {
-        vector<Texture> textures;
+        vector<TextureRef> textures;
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++)
         {
             aiString str;
             mat->GetTexture(type, i, &str);
-            bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++)
-            {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true;
-                    break;
-                }
-            }
-            if(!skip)
-            {
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);
-            }
+            textures.push_back(TextureRef{ typeName, str.C_Str() });
+            requestTexture(str.C_Str());
         }
         return textures;
     }
+
+    // acquires a texture from the registry once per model, later requests reuse it
+    Texture loadTexture(const char *path, const string &typeName, TextureUploader &uploader)
+    {
+        auto loaded = textureIndex.find(path);
+        if(loaded != textureIndex.end())
+            return textures_loaded[loaded->second];
+        Texture texture;
+        texture.id = TextureRegistry::Shared().Acquire(directory + '/' + path, uploader);
+        texture.type = typeName;
+        texture.path = path;
+        textureIndex[texture.path] = textures_loaded.size();
+        textures_loaded.push_back(texture);
+        return texture;
+    }
 };
 
+// shared through TextureRegistry, release the result with TextureRegistry::Shared().Release()
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
 {
     string filename = string(path);
     filename = directory + '/' + filename;
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1) format = GL_RED;
-        else if (nrComponents == 3) format = GL_RGB;
-        else if (nrComponents == 4) format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
+    TextureUploader uploader(false);
+    return TextureRegistry::Shared().Acquire(filename, uploader);
 }
 #endif
@@ -0,0 +1,280 @@
+#ifndef PACKED_MESH_H
+#define PACKED_MESH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <learnopengl/frustum.h>
+#include <learnopengl/mesh.h>
+#include <learnopengl/shader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Vertex storage choice for Model. Full keeps the float Vertex / Mesh path, Packed converts every
+// mesh to a PackedMesh layout picked per mesh (static or skinned).
+enum class VertexFormat
+{
+    Full,
+    Packed
+};
+
+// Compact GPU vertex layouts, attribute locations match the Vertex layout used by the shaders:
+//   0 position   3 x float
+//   1 normal     snorm 10:10:10:2
+//   2 texcoords  2 x half float
+//   3 tangent    snorm 10:10:10:2, w = bitangent handedness (location 4 is left unbound)
+//   5 bone ids   4 x int8 (int16 for skeletons above 127 bones), -1 = unused slot
+//   6 weights    4 x unorm8
+// A static vertex is 24 bytes and a skinned one 32 (36) bytes, against 88 for Vertex.
+struct PackedVertex
+{
+    glm::vec3 Position;
+    uint32_t Normal;
+    uint32_t TexCoords;
+    uint32_t Tangent;
+};
+
+class PackedMesh
+{
+public:
+    enum Layout
+    {
+        STATIC = 0,
+        SKINNED_8 = 1,
+        SKINNED_16 = 2
+    };
+
+    Layout layout;
+    unsigned int vertexCount;
+    unsigned int indexCount;
+    GLenum indexType;
+    std::vector<unsigned char> vertexData;
+    std::vector<unsigned char> indexData;
+    std::vector<Texture> textures;
+    unsigned int VAO = 0;
+
+    // packs float vertices; skinned meshes keep their bone ids and weights.
+    // upload = false leaves the GL objects to a later Upload(), so packing can run off the GL thread
+    PackedMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture>& textures, bool skinned, bool upload = true)
+    {
+        this->textures = textures;
+        vertexCount = (unsigned int)vertices.size();
+        layout = STATIC;
+        if (skinned)
+        {
+            int maxBone = 0;
+            for (const Vertex& v : vertices)
+                for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+                    maxBone = std::max(maxBone, v.m_BoneIDs[i]);
+            layout = maxBone <= 127 ? SKINNED_8 : SKINNED_16;
+        }
+
+        unsigned int stride = Stride(layout);
+        vertexData.resize((size_t)vertexCount * stride);
+        for (unsigned int i = 0; i < vertexCount; i++)
+            PackVertex(vertices[i], &vertexData[(size_t)i * stride]);
+        PackIndices(indices);
+
+        if (upload) setupMesh();
+    }
+
+    // adopts data that is already in a packed layout (e.g. read back from a cache)
+    PackedMesh(Layout layout, std::vector<unsigned char> vertexData, unsigned int vertexCount,
+               std::vector<unsigned char> indexData, unsigned int indexCount, GLenum indexType, const std::vector<Texture>& textures, bool upload = true)
+        : layout(layout), vertexCount(vertexCount), indexCount(indexCount), indexType(indexType),
+          vertexData(std::move(vertexData)), indexData(std::move(indexData)), textures(textures)
+    {
+        if (upload) setupMesh();
+    }
+
+    // creates the GL buffers of a mesh constructed with upload = false
+    void Upload()
+    {
+        if (!VAO) setupMesh();
+    }
+
+    static unsigned int Stride(Layout layout)
+    {
+        switch (layout)
+        {
+        case SKINNED_8:  return sizeof(PackedVertex) + 4 + 4;
+        case SKINNED_16: return sizeof(PackedVertex) + 8 + 4;
+        default:         return sizeof(PackedVertex);
+        }
+    }
+
+    // render the mesh, textures are bound the same way Mesh::Draw does
+    void Draw(Shader& shader)
+    {
+        BindTextures(shader);
+        // static meshes of a skinned model are drawn with the skinning shader too; their bone
+        // attributes are disabled, so give them the "no bone" values a skinned vertex would carry
+        // (the float default (0, 0, 0, 1) read as ivec4 is undefined)
+        if (layout == STATIC)
+        {
+            glVertexAttribI4i(5, -1, -1, -1, -1);
+            glVertexAttrib4f(6, 0.0f, 0.0f, 0.0f, 0.0f);
+        }
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void BindTextures(Shader& shader)
+    {
+        BindTextures(shader, textures);
+    }
+
+    // binds textures to units 0.. and points the texture_<type>N samplers at them
+    static void BindTextures(Shader& shader, const std::vector<Texture>& textures)
+    {
+        unsigned int diffuseNr = 1;
+        unsigned int specularNr = 1;
+        unsigned int normalNr = 1;
+        unsigned int heightNr = 1;
+        for (unsigned int i = 0; i < textures.size(); i++)
+        {
+            glActiveTexture(GL_TEXTURE0 + i);
+            std::string number;
+            std::string name = textures[i].type;
+            if (name == "texture_diffuse") number = std::to_string(diffuseNr++);
+            else if (name == "texture_specular") number = std::to_string(specularNr++);
+            else if (name == "texture_normal") number = std::to_string(normalNr++);
+            else if (name == "texture_height") number = std::to_string(heightNr++);
+            shader.setInt(name + number, i);
+            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        }
+    }
+
+    size_t ByteSize() const { return vertexData.size() + indexData.size(); }
+
+    // bounds of the vertex positions (bind pose for skinned layouts)
+    BoundingBox Bounds() const
+    {
+        BoundingBox bounds;
+        unsigned int stride = Stride(layout);
+        for (unsigned int i = 0; i < vertexCount; i++)
+        {
+            glm::vec3 position;
+            std::memcpy(&position, &vertexData[(size_t)i * stride + offsetof(PackedVertex, Position)], sizeof(position));
+            bounds.Expand(position);
+        }
+        return bounds;
+    }
+
+private:
+    unsigned int VBO = 0, EBO = 0;
+
+    void PackVertex(const Vertex& v, unsigned char* out) const
+    {
+        PackedVertex p;
+        p.Position = v.Position;
+        p.Normal = glm::packSnorm3x10_1x2(glm::vec4(SafeNormalize(v.Normal), 0.0f));
+        p.TexCoords = glm::packHalf2x16(v.TexCoords);
+        glm::vec3 tangent = SafeNormalize(v.Tangent);
+        float handedness = glm::dot(glm::cross(v.Normal, v.Tangent), v.Bitangent) < 0.0f ? -1.0f : 1.0f;
+        p.Tangent = glm::packSnorm3x10_1x2(glm::vec4(tangent, handedness));
+        std::memcpy(out, &p, sizeof(PackedVertex));
+        if (layout == STATIC) return;
+
+        unsigned char* bones = out + sizeof(PackedVertex);
+        unsigned char* weights = bones + (layout == SKINNED_8 ? 4 : 8);
+        float total = 0.0f;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+            if (v.m_BoneIDs[i] >= 0) total += std::max(v.m_Weights[i], 0.0f);
+
+        int quantized[MAX_BONE_INFLUENCE];
+        int sum = 0, largest = 0;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+        {
+            bool used = v.m_BoneIDs[i] >= 0 && total > 0.0f;
+            quantized[i] = used ? (int)std::lround(std::max(v.m_Weights[i], 0.0f) / total * 255.0f) : 0;
+            sum += quantized[i];
+            if (quantized[i] > quantized[largest]) largest = i;
+            if (layout == SKINNED_8)
+                ((int8_t*)bones)[i] = (int8_t)v.m_BoneIDs[i];
+            else
+            {
+                int16_t id = (int16_t)v.m_BoneIDs[i];
+                std::memcpy(bones + i * 2, &id, 2);
+            }
+        }
+        // rounding must not change the total, so the dominant influence absorbs the difference
+        if (sum > 0) quantized[largest] += 255 - sum;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+            weights[i] = (unsigned char)quantized[i];
+    }
+
+    void PackIndices(const std::vector<unsigned int>& indices)
+    {
+        indexCount = (unsigned int)indices.size();
+        if (vertexCount <= 65536)
+        {
+            indexType = GL_UNSIGNED_SHORT;
+            indexData.resize(indices.size() * sizeof(uint16_t));
+            uint16_t* out = (uint16_t*)indexData.data();
+            for (size_t i = 0; i < indices.size(); i++)
+                out[i] = (uint16_t)indices[i];
+        }
+        else
+        {
+            indexType = GL_UNSIGNED_INT;
+            indexData.resize(indices.size() * sizeof(uint32_t));
+            std::memcpy(indexData.data(), indices.data(), indexData.size());
+        }
+    }
+
+    static glm::vec3 SafeNormalize(const glm::vec3& v)
+    {
+        float length = glm::length(v);
+        return length > 0.0f ? v / length : glm::vec3(0.0f);
+    }
+
+    void setupMesh()
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size(), indexData.data(), GL_STATIC_DRAW);
+
+        GLsizei stride = Stride(layout);
+        // vertex Positions
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, Position));
+        // vertex normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, Normal));
+        // vertex texture coords
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, TexCoords));
+        // vertex tangent
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, Tangent));
+        if (layout != STATIC)
+        {
+            size_t bones = sizeof(PackedVertex);
+            size_t weights = bones + (layout == SKINNED_8 ? 4 : 8);
+            // ids
+            glEnableVertexAttribArray(5);
+            glVertexAttribIPointer(5, 4, layout == SKINNED_8 ? GL_BYTE : GL_SHORT, stride, (void*)bones);
+            // weights
+            glEnableVertexAttribArray(6);
+            glVertexAttribPointer(6, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)weights);
+        }
+        glBindVertexArray(0);
+    }
+};
+#endif
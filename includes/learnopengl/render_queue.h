@@ -0,0 +1,126 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Opaque draw items collected by the passes of a frame and submitted in sorted order: by program,
+// texture and vertex array, then front to back so early depth testing rejects hidden fragments.
+// Blended geometry (the particles) is drawn outside the queue. Flush() binds a program, texture
+// or vertex array only when it differs from the previous item.
+// Sort keys hold the low bits of the GL names, two names sharing them only cost an extra bind.
+class RenderQueue
+{
+public:
+    static constexpr float MAX_DEPTH = 500.0f; // matches the far plane, deeper items sort last
+
+    struct DrawItem
+    {
+        unsigned int program = 0;
+        unsigned int texture = 0;          // 2D texture on unit 0, 0 keeps whatever is bound
+        unsigned int vertexArray = 0;
+        GLenum mode = GL_TRIANGLES;
+        GLsizei count = 0;
+        GLenum indexType = 0;              // 0 draws arrays
+        size_t offset = 0;                 // first vertex, or byte offset into the index buffer
+        GLsizei instanceCount = 0;         // > 0 draws that many instances
+        // glMultiDrawElements ranges, used instead of count / offset when multiDrawCount > 0;
+        // the arrays must stay valid until Flush()
+        const GLsizei* multiCounts = nullptr;
+        const void* const* multiOffsets = nullptr;
+        GLsizei multiDrawCount = 0;
+        GLint modelLocation = -1;
+        glm::mat4 model = glm::mat4(1.0f);
+    };
+
+    // state changes actually issued, summed until ResetStats()
+    struct Stats
+    {
+        unsigned int draws = 0;
+        unsigned int programBinds = 0;
+        unsigned int textureBinds = 0;
+        unsigned int vertexArrayBinds = 0;
+    };
+
+    // depth is the distance from the camera
+    void Submit(float depth, const DrawItem& item)
+    {
+        uint64_t program = item.program & 0x3FF;
+        uint64_t texture = item.texture & 0x3FFF;
+        uint64_t vertexArray = item.vertexArray & 0x3FFF;
+        uint64_t quantized = (uint64_t)(glm::clamp(depth / MAX_DEPTH, 0.0f, 1.0f) * 0xFFFFFF);
+        uint64_t key = program << 52 | texture << 38 | vertexArray << 24 | quantized;
+        order.push_back(Entry{ key, (uint32_t)items.size() });
+        items.push_back(item);
+    }
+
+    // draws everything submitted since the last flush and empties the queue. Bindings made outside
+    // the queue are unknown, so the first item always binds; leaves vertex array 0 bound
+    void Flush()
+    {
+        std::sort(order.begin(), order.end(), [](const Entry& a, const Entry& b)
+        {
+            return a.key != b.key ? a.key < b.key : a.item < b.item;
+        });
+        const unsigned int unknown = ~0u;
+        unsigned int program = unknown, texture = unknown, vertexArray = unknown;
+        glActiveTexture(GL_TEXTURE0);
+        for (const Entry& entry : order)
+        {
+            const DrawItem& item = items[entry.item];
+            if (item.program != program)
+            {
+                glUseProgram(item.program);
+                program = item.program;
+                stats.programBinds++;
+            }
+            if (item.texture && item.texture != texture)
+            {
+                glBindTexture(GL_TEXTURE_2D, item.texture);
+                texture = item.texture;
+                stats.textureBinds++;
+            }
+            if (item.vertexArray != vertexArray)
+            {
+                glBindVertexArray(item.vertexArray);
+                vertexArray = item.vertexArray;
+                stats.vertexArrayBinds++;
+            }
+            if (item.modelLocation >= 0) glUniformMatrix4fv(item.modelLocation, 1, GL_FALSE, &item.model[0][0]);
+
+            if (item.multiDrawCount > 0)
+                glMultiDrawElements(item.mode, item.multiCounts, item.indexType, item.multiOffsets, item.multiDrawCount);
+            else if (item.indexType && item.instanceCount > 0)
+                glDrawElementsInstanced(item.mode, item.count, item.indexType, (const void*)item.offset, item.instanceCount);
+            else if (item.indexType)
+                glDrawElements(item.mode, item.count, item.indexType, (const void*)item.offset);
+            else if (item.instanceCount > 0)
+                glDrawArraysInstanced(item.mode, (GLint)item.offset, item.count, item.instanceCount);
+            else
+                glDrawArrays(item.mode, (GLint)item.offset, item.count);
+            stats.draws++;
+        }
+        glBindVertexArray(0);
+        items.clear();
+        order.clear();
+    }
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    std::vector<DrawItem> items;
+    std::vector<Entry> order;
+    Stats stats;
+};
+#endif
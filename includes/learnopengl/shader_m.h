@@ -4,16 +4,77 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// ARB_get_program_binary (core since 4.1), looked up at runtime as the loader targets 3.3
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
 
 class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
+
+    // lightweight handle to a resolved uniform location; fetch once with uniform<T>(name)
+    // and call set() in the render loop without any string work or driver lookups.
+    // like the setX functions, set() applies to the currently bound program.
+    template <typename T>
+    struct Uniform
+    {
+        GLint location = -1;
+
+        bool valid() const { return location >= 0; }
+        void set(const T& value) const { Shader::upload(location, &value, 1); }
+        // uploads count consecutive elements of a uniform array starting at this location
+        void set(const T* values, GLsizei count) const { Shader::upload(location, values, count); }
+    };
+
+    // turns on the program binary cache: linked programs are stored in directory, keyed by a hash
+    // of their sources and the driver strings, and reloaded on later runs. needs a current context;
+    // getProcAddress (e.g. glfwGetProcAddress) resolves the ARB_get_program_binary entry points.
+    // without driver support it stays off and every program compiles from source.
+    // ------------------------------------------------------------------------
+    static bool EnableProgramBinaryCache(GLADloadproc getProcAddress, const std::string &directory = "shader_cache")
+    {
+        BinaryCache& cache = binaryCache();
+        cache.getProgramBinary = (GetProgramBinaryProc)getProcAddress("glGetProgramBinary");
+        cache.programBinary = (ProgramBinaryProc)getProcAddress("glProgramBinary");
+        cache.programParameteri = (ProgramParameteriProc)getProcAddress("glProgramParameteri");
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        glGetError(); // the query is itself an error on drivers without the extension
+        cache.enabled = cache.getProgramBinary && cache.programBinary && cache.programParameteri && formats > 0;
+        if (!cache.enabled) return false;
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        cache.directory = directory;
+        cache.driverHash = 14695981039346656037ull;
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        {
+            const char* text = (const char*)glGetString(name);
+            cache.driverHash = hashText(text ? text : "", cache.driverHash);
+        }
+        return true;
+    }
+
+    // constructor generates the shader on the fly. Shader objects built from identical sources
+    // share one program, which comes from the binary cache when that is enabled and still valid.
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
     {
@@ -45,30 +106,31 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-
+        // 2. link (or reuse) the program and resolve its uniforms
+        link(vertexCode, fragmentCode, {});
+    }
+    // vertex-only program for transform feedback: feedbackVaryings are captured interleaved, in
+    // the given order, into the buffer bound to GL_TRANSFORM_FEEDBACK_BUFFER index 0. draw with
+    // GL_RASTERIZER_DISCARD enabled, there is no fragment stage
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const std::vector<std::string> &feedbackVaryings)
+    {
+        std::string vertexCode;
+        std::ifstream vShaderFile;
+        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        try 
+        {
+            vShaderFile.open(vertexPath);
+            std::stringstream vShaderStream;
+            vShaderStream << vShaderFile.rdbuf();
+            vShaderFile.close();
+            vertexCode = vShaderStream.str();
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+        }
+        link(vertexCode, "", feedbackVaryings);
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -76,66 +138,318 @@ public:
     { 
         glUseProgram(ID); 
     }
+    // returns a typed handle for a uniform (or uniform array), invalid if the uniform is not active
+    // ------------------------------------------------------------------------
+    template <typename T>
+    Uniform<T> uniform(const std::string &name) const
+    {
+        Uniform<T> handle;
+        handle.location = getUniformLocation(name);
+        return handle;
+    }
+    // attaches the named uniform block to a buffer binding point, ignored if the program lacks it
+    // ------------------------------------------------------------------------
+    void bindUniformBlock(const std::string &name, GLuint binding) const
+    {
+        GLuint index = glGetUniformBlockIndex(ID, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
+    }
+    // cached location lookup, -1 if the program has no such active uniform
+    // ------------------------------------------------------------------------
+    GLint getUniformLocation(const std::string &name) const
+    {
+        auto it = uniformLocations.find(name);
+        return it != uniformLocations.end() ? it->second : -1;
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        glUniform1i(getUniformLocation(name), (int)value); 
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        glUniform1i(getUniformLocation(name), value); 
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        glUniform1f(getUniformLocation(name), value); 
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
     { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform2fv(getUniformLocation(name), 1, &value[0]); 
     }
     void setVec2(const std::string &name, float x, float y) const
     { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+        glUniform2f(getUniformLocation(name), x, y); 
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform3fv(getUniformLocation(name), 1, &value[0]); 
     }
     void setVec3(const std::string &name, float x, float y, float z) const
     { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+        glUniform3f(getUniformLocation(name), x, y, z); 
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
     { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform4fv(getUniformLocation(name), 1, &value[0]); 
     }
     void setVec4(const std::string &name, float x, float y, float z, float w) const
     { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+        glUniform4f(getUniformLocation(name), x, y, z, w); 
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+    }
+    // uploads a whole uniform array in one call, e.g. setMat4Array("finalBonesMatrices", ...)
+    // ------------------------------------------------------------------------
+    void setMat4Array(const std::string &name, const glm::mat4 *mats, GLsizei count) const
+    {
+        glUniformMatrix4fv(getUniformLocation(name), count, GL_FALSE, &mats[0][0][0]);
     }
 
+    // raw uploads used by Uniform<T>::set
+    // ------------------------------------------------------------------------
+    static void upload(GLint location, const int *v, GLsizei count)       { glUniform1iv(location, count, v); }
+    static void upload(GLint location, const float *v, GLsizei count)     { glUniform1fv(location, count, v); }
+    static void upload(GLint location, const glm::vec2 *v, GLsizei count) { glUniform2fv(location, count, &v[0][0]); }
+    static void upload(GLint location, const glm::vec3 *v, GLsizei count) { glUniform3fv(location, count, &v[0][0]); }
+    static void upload(GLint location, const glm::vec4 *v, GLsizei count) { glUniform4fv(location, count, &v[0][0]); }
+    static void upload(GLint location, const glm::mat3 *m, GLsizei count) { glUniformMatrix3fv(location, count, GL_FALSE, &m[0][0][0]); }
+    static void upload(GLint location, const glm::mat4 *m, GLsizei count) { glUniformMatrix4fv(location, count, GL_FALSE, &m[0][0][0]); }
+
 private:
+    typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+    typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+    typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+    struct BinaryCache
+    {
+        bool enabled = false;
+        std::string directory;
+        uint64_t driverHash = 0;
+        GetProgramBinaryProc getProgramBinary = nullptr;
+        ProgramBinaryProc programBinary = nullptr;
+        ProgramParameteriProc programParameteri = nullptr;
+    };
+
+    static constexpr uint32_t BINARY_MAGIC = 0x4E494250; // "PBIN"
+    static constexpr int32_t MAX_BINARY_LENGTH = 1 << 26;
+
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    static BinaryCache& binaryCache()
+    {
+        static BinaryCache cache;
+        return cache;
+    }
+
+    // source hash -> program, shared by every Shader built from those sources
+    static std::unordered_map<uint64_t, unsigned int>& linkedPrograms()
+    {
+        static std::unordered_map<uint64_t, unsigned int> programs;
+        return programs;
+    }
+
+    // FNV-1a, terminated so that splitting the same text differently changes the hash
+    static uint64_t hashText(const char *text, uint64_t hash)
+    {
+        for (; *text; text++)
+            hash = (hash ^ (unsigned char)*text) * 1099511628211ull;
+        return (hash ^ 0xFF) * 1099511628211ull;
+    }
+
+    // reuses a program linked from the same sources, else loads its cached binary, else compiles;
+    // then resolves every active uniform once so later lookups never hit the driver
+    // ------------------------------------------------------------------------
+    void link(const std::string &vertexCode, const std::string &fragmentCode, const std::vector<std::string> &feedbackVaryings)
+    {
+        uint64_t sourceHash = hashText(fragmentCode.c_str(), hashText(vertexCode.c_str(), 14695981039346656037ull));
+        for (const std::string& varying : feedbackVaryings)
+            sourceHash = hashText(varying.c_str(), sourceHash);
+        auto shared = linkedPrograms().find(sourceHash);
+        if (shared != linkedPrograms().end())
+            ID = shared->second;
+        else
+        {
+            if (!loadProgramBinary(sourceHash))
+            {
+                compileProgram(vertexCode, fragmentCode, feedbackVaryings);
+                saveProgramBinary(sourceHash);
+            }
+            linkedPrograms()[sourceHash] = ID;
+        }
+        cacheUniformLocations();
+    }
+
+    static std::string binaryPath(uint64_t sourceHash)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.program", (unsigned long long)sourceHash);
+        return binaryCache().directory + "/" + name;
+    }
+
+    // file layout: magic, driver hash, binary format, binary length, binary. any mismatch, or a
+    // binary the driver refuses to link, falls back to compiling from source
+    // ------------------------------------------------------------------------
+    bool loadProgramBinary(uint64_t sourceHash)
+    {
+        BinaryCache& cache = binaryCache();
+        if (!cache.enabled) return false;
+        std::ifstream file(binaryPath(sourceHash), std::ios::binary);
+        if (!file) return false;
+        uint32_t magic = 0;
+        uint64_t driverHash = 0;
+        uint32_t format = 0;
+        int32_t length = 0;
+        file.read((char*)&magic, sizeof(magic));
+        file.read((char*)&driverHash, sizeof(driverHash));
+        file.read((char*)&format, sizeof(format));
+        file.read((char*)&length, sizeof(length));
+        if (!file || magic != BINARY_MAGIC || driverHash != cache.driverHash || length <= 0 || length > MAX_BINARY_LENGTH) return false;
+        std::vector<char> binary(length);
+        if (!file.read(binary.data(), length)) return false;
+
+        ID = glCreateProgram();
+        cache.programBinary(ID, (GLenum)format, binary.data(), length);
+        GLint success = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        if (success) return true;
+        glDeleteProgram(ID);
+        ID = 0;
+        return false;
+    }
+
+    // written to a temporary file first, so an interrupted run never leaves a truncated binary
+    // ------------------------------------------------------------------------
+    void saveProgramBinary(uint64_t sourceHash) const
+    {
+        BinaryCache& cache = binaryCache();
+        if (!cache.enabled) return;
+        GLint success = 0, length = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (!success || length <= 0 || length > MAX_BINARY_LENGTH) return;
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        cache.getProgramBinary(ID, length, &written, &format, binary.data());
+        if (written <= 0) return;
+
+        std::string path = binaryPath(sourceHash);
+        uint32_t storedFormat = format;
+        int32_t storedLength = written;
+        std::ofstream file(path + ".tmp", std::ios::binary);
+        file.write((const char*)&BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        file.write((const char*)&cache.driverHash, sizeof(cache.driverHash));
+        file.write((const char*)&storedFormat, sizeof(storedFormat));
+        file.write((const char*)&storedLength, sizeof(storedLength));
+        file.write(binary.data(), written);
+        file.close();
+        std::error_code error;
+        if (file)
+            std::filesystem::rename(path + ".tmp", path, error);
+        else
+            std::filesystem::remove(path + ".tmp", error);
+    }
+
+    // compiles and links the program from source into ID. an empty fragmentCode leaves out the
+    // fragment stage, feedbackVaryings are set up before linking
+    // ------------------------------------------------------------------------
+    void compileProgram(const std::string &vertexCode, const std::string &fragmentCode, const std::vector<std::string> &feedbackVaryings)
+    {
+        const char* vShaderCode = vertexCode.c_str();
+        const char * fShaderCode = fragmentCode.c_str();
+        unsigned int vertex, fragment = 0;
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+        // fragment Shader
+        if (!fragmentCode.empty())
+        {
+            fragment = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(fragment, 1, &fShaderCode, NULL);
+            glCompileShader(fragment);
+            checkCompileErrors(fragment, "FRAGMENT");
+        }
+        // shader Program
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        if (fragment)
+            glAttachShader(ID, fragment);
+        if (!feedbackVaryings.empty())
+        {
+            std::vector<const char*> names;
+            for (const std::string& varying : feedbackVaryings)
+                names.push_back(varying.c_str());
+            glTransformFeedbackVaryings(ID, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+        }
+        if (binaryCache().enabled)
+            binaryCache().programParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        if (fragment)
+            glDeleteShader(fragment);
+    }
+
+    // enumerates the active uniforms after linking. arrays are reported as "name[0]", so they
+    // are registered under the bare name (for whole-array uploads) and under every "name[i]".
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        uniformLocations.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string buffer(maxLength > 0 ? maxLength : 1, '\0');
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, maxLength, &length, &size, &type, &buffer[0]);
+            std::string name(buffer.data(), length);
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0) continue; // uniform block members have no location
+            uniformLocations[name] = location;
+
+            std::string::size_type bracket = name.find('[');
+            if (bracket != std::string::npos && name.compare(bracket, std::string::npos, "[0]") == 0)
+            {
+                std::string base = name.substr(0, bracket);
+                uniformLocations[base] = location;
+                for (GLint e = 1; e < size; e++)
+                {
+                    std::string element = base + "[" + std::to_string(e) + "]";
+                    uniformLocations[element] = glGetUniformLocation(ID, element.c_str());
+                }
+            }
+        }
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
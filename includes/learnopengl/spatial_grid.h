@@ -0,0 +1,158 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Broadphase over a level grid in the XZ plane. Cells are centered on multiples of the cell size,
+// like the tiles of LevelMesh, and each keeps the ids of the items whose footprint (a disc)
+// overlaps it, so an item wider than a cell sits in several. Queries only visit the cells around
+// a point or along a ray and report every item once, so their cost depends on the area covered,
+// not on how many items the grid holds. Callbacks return true to end the query early and must
+// not insert or remove items.
+class SpatialGrid
+{
+public:
+    void Init(int width, int depth, float cellSize)
+    {
+        this->width = width;
+        this->depth = depth;
+        cell = cellSize;
+        cells.assign((size_t)width * depth, std::vector<int>());
+        items.clear();
+        stamps.clear();
+        query = 0;
+    }
+
+    // (re)places id with a footprint of radius around position; footprints off the grid are dropped
+    void Insert(int id, const glm::vec3& position, float radius)
+    {
+        if (id >= (int)items.size())
+        {
+            items.resize(id + 1);
+            stamps.resize(id + 1, 0);
+        }
+        Remove(id);
+        Item& item = items[id];
+        item.minX = std::max(cellCoordinate(position.x - radius), 0);
+        item.minZ = std::max(cellCoordinate(position.z - radius), 0);
+        item.maxX = std::min(cellCoordinate(position.x + radius), width - 1);
+        item.maxZ = std::min(cellCoordinate(position.z + radius), depth - 1);
+        if (item.minX > item.maxX || item.minZ > item.maxZ) return;
+        item.present = true;
+        for (int z = item.minZ; z <= item.maxZ; z++)
+            for (int x = item.minX; x <= item.maxX; x++)
+                cells[(size_t)z * width + x].push_back(id);
+    }
+
+    // false if id is not in the grid
+    bool Remove(int id)
+    {
+        if (id < 0 || id >= (int)items.size() || !items[id].present) return false;
+        Item& item = items[id];
+        for (int z = item.minZ; z <= item.maxZ; z++)
+        {
+            for (int x = item.minX; x <= item.maxX; x++)
+            {
+                std::vector<int>& bucket = cells[(size_t)z * width + x];
+                auto it = std::find(bucket.begin(), bucket.end(), id);
+                *it = bucket.back();
+                bucket.pop_back();
+            }
+        }
+        item.present = false;
+        return true;
+    }
+
+    // empties every cell, keeping their storage
+    void Clear()
+    {
+        for (std::vector<int>& bucket : cells)
+            bucket.clear();
+        for (Item& item : items)
+            item.present = false;
+    }
+
+    // calls f(id) for the items in the cells overlapping the square of radius around position
+    template <typename F>
+    void ForEachNear(const glm::vec3& position, float radius, F f)
+    {
+        beginQuery();
+        int minX = std::max(cellCoordinate(position.x - radius), 0);
+        int minZ = std::max(cellCoordinate(position.z - radius), 0);
+        int maxX = std::min(cellCoordinate(position.x + radius), width - 1);
+        int maxZ = std::min(cellCoordinate(position.z + radius), depth - 1);
+        for (int z = minZ; z <= maxZ; z++)
+            for (int x = minX; x <= maxX; x++)
+                if (visit(x, z, f)) return;
+    }
+
+    // calls f(id) for the items in every cell the ray crosses, cell by cell from origin until it
+    // leaves the grid (grid traversal by Amanatides & Woo, ignoring height)
+    template <typename F>
+    void ForEachAlongRay(const glm::vec3& origin, const glm::vec3& direction, F f)
+    {
+        beginQuery();
+        glm::vec2 start(origin.x / cell + 0.5f, origin.z / cell + 0.5f);
+        glm::vec2 heading(direction.x, direction.z);
+        int x = (int)std::floor(start.x);
+        int z = (int)std::floor(start.y);
+        int stepX = heading.x >= 0.0f ? 1 : -1;
+        int stepZ = heading.y >= 0.0f ? 1 : -1;
+        float deltaX = heading.x != 0.0f ? std::abs(1.0f / heading.x) : 1e30f;
+        float deltaZ = heading.y != 0.0f ? std::abs(1.0f / heading.y) : 1e30f;
+        float nextX = (stepX > 0 ? x + 1 - start.x : start.x - x) * deltaX;
+        float nextZ = (stepZ > 0 ? z + 1 - start.y : start.y - z) * deltaZ;
+        while (x >= 0 && x < width && z >= 0 && z < depth)
+        {
+            if (visit(x, z, f)) return;
+            if (heading.x == 0.0f && heading.y == 0.0f) return;
+            if (nextX < nextZ) { x += stepX; nextX += deltaX; }
+            else { z += stepZ; nextZ += deltaZ; }
+        }
+    }
+
+private:
+    struct Item
+    {
+        int minX = 0, minZ = 0, maxX = -1, maxZ = -1; // cells covered by the footprint
+        bool present = false;
+    };
+
+    int width = 0;
+    int depth = 0;
+    float cell = 1.0f;
+    std::vector<std::vector<int>> cells; // ids per cell, row major
+    std::vector<Item> items;
+    std::vector<uint32_t> stamps;        // last query that reported each id
+    uint32_t query = 0;
+
+    int cellCoordinate(float position) const { return (int)std::floor(position / cell + 0.5f); }
+
+    void beginQuery()
+    {
+        if (++query == 0)
+        {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            query = 1;
+        }
+    }
+
+    // reports the ids of one cell not reported yet in this query, true once f asks to stop
+    template <typename F>
+    bool visit(int x, int z, F& f)
+    {
+        for (int id : cells[(size_t)z * width + x])
+        {
+            if (stamps[id] == query) continue;
+            stamps[id] = query;
+            if (f(id)) return true;
+        }
+        return false;
+    }
+};
+#endif
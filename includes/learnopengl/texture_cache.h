@@ -0,0 +1,331 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/baked_cache.h>
+#include <learnopengl/texture_loader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// First-run transcoder for image textures. Load() returns the image with a complete precomputed
+// mip chain, read from a cache file next to the source ("x.png.tex.bake", see BakedCache) when
+// one is valid, otherwise decoded with stb_image, box filtered down to 1x1, block compressed and
+// written to the cache for the next run:
+//   RGB   BC1 / DXT1 (8 bytes per 4x4 block, 6:1)   needs GL_EXT_texture_compression_s3tc
+//   RGBA  BC3 / DXT5 (16 bytes per 4x4 block, 4:1)  needs GL_EXT_texture_compression_s3tc
+//   R     BC4 / RGTC1 (8 bytes per 4x4 block, 2:1)  core since GL 3.0
+// Without S3TC, RGB and RGBA keep uncompressed levels, which still skips decoding and mip
+// generation at startup. Call DetectSupport() once on the GL thread before loading; the choice is
+// part of the cache parameters, so a cache baked for the other case is rebuilt.
+// Images are decoded with the stb_image flip setting current at bake time.
+class TextureCache
+{
+public:
+    static constexpr uint32_t ENCODER_VERSION = 1;
+
+    static void DetectSupport()
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        bool s3tc = false;
+        for (GLint i = 0; i < count && !s3tc; i++)
+        {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            s3tc = name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0;
+        }
+        S3tc().store(s3tc);
+    }
+
+    static bool S3tcSupported() { return S3tc().load(); }
+
+    // any thread
+    static DecodedImage Load(const std::string& path)
+    {
+        bool s3tc = S3tcSupported();
+        uint64_t parameters = ((uint64_t)ENCODER_VERSION << 1) | (s3tc ? 1u : 0u);
+        DecodedImage image;
+        if (ReadCache(path, parameters, image))
+            return image;
+
+        image = DecodeImage(path);
+        if (!image.Valid()) return image;
+        Transcode(image, s3tc);
+        if (!WriteCache(path, parameters, image))
+            std::cout << "ERROR::TEXTURE::BAKE failed to write cache for " << path << std::endl;
+        return image;
+    }
+
+    // replaces the single level of a freshly decoded image with a full, possibly compressed, chain
+    static void Transcode(DecodedImage& image, bool s3tc)
+    {
+        std::vector<ImageLevel> chain = BuildMipChain(image.levels->front(), image.components);
+        if (image.components == 3 && s3tc) image.compressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        else if (image.components == 4 && s3tc) image.compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        else if (image.components == 1) image.compressedFormat = GL_COMPRESSED_RED_RGTC1;
+        if (image.compressedFormat)
+            for (ImageLevel& level : chain)
+                level.data = Compress(level, image.components, image.compressedFormat);
+        image.levels = std::make_shared<const std::vector<ImageLevel>>(std::move(chain));
+    }
+
+private:
+    static std::atomic<bool>& S3tc()
+    {
+        static std::atomic<bool> supported(false);
+        return supported;
+    }
+
+    static bool ReadCache(const std::string& path, uint64_t parameters, DecodedImage& image)
+    {
+        BakedCache::Reader reader(path, BakedCache::TEXTURE, parameters);
+        if (!reader.Valid()) return false;
+        int32_t width = 0, height = 0, components = 0;
+        uint32_t compressedFormat = 0, levelCount = 0;
+        reader.Read(width);
+        reader.Read(height);
+        reader.Read(components);
+        reader.Read(compressedFormat);
+        reader.Read(levelCount);
+        auto levels = std::make_shared<std::vector<ImageLevel>>();
+        for (uint32_t i = 0; i < levelCount && i < 32 && reader.Valid(); i++)
+        {
+            ImageLevel level;
+            int32_t levelWidth = 0, levelHeight = 0;
+            reader.Read(levelWidth);
+            reader.Read(levelHeight);
+            reader.ReadVector(level.data);
+            level.width = levelWidth;
+            level.height = levelHeight;
+            levels->push_back(std::move(level));
+        }
+        if (!reader.Valid() || levels->empty() || levels->size() != levelCount)
+        {
+            std::cout << "ERROR::TEXTURE::BAKE corrupt cache for " << path << ", transcoding again" << std::endl;
+            return false;
+        }
+        image.path = path;
+        image.width = width;
+        image.height = height;
+        image.components = components;
+        image.compressedFormat = compressedFormat;
+        image.levels = levels;
+        return true;
+    }
+
+    static bool WriteCache(const std::string& path, uint64_t parameters, const DecodedImage& image)
+    {
+        BakedCache::Writer writer(path, BakedCache::TEXTURE, parameters);
+        writer.Write((int32_t)image.width);
+        writer.Write((int32_t)image.height);
+        writer.Write((int32_t)image.components);
+        writer.Write((uint32_t)image.compressedFormat);
+        writer.Write((uint32_t)image.levels->size());
+        for (const ImageLevel& level : *image.levels)
+        {
+            writer.Write((int32_t)level.width);
+            writer.Write((int32_t)level.height);
+            writer.WriteVector(level.data);
+        }
+        return writer.Commit();
+    }
+
+    // 2x2 box filter per level; odd edges reuse the last row / column
+    static std::vector<ImageLevel> BuildMipChain(const ImageLevel& base, int components)
+    {
+        std::vector<ImageLevel> chain;
+        chain.push_back(base);
+        while (chain.back().width > 1 || chain.back().height > 1)
+        {
+            const ImageLevel& src = chain.back();
+            ImageLevel dst;
+            dst.width = std::max(1, src.width / 2);
+            dst.height = std::max(1, src.height / 2);
+            dst.data.resize((size_t)dst.width * dst.height * components);
+            for (int y = 0; y < dst.height; y++)
+            {
+                int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+                for (int x = 0; x < dst.width; x++)
+                {
+                    int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+                    for (int c = 0; c < components; c++)
+                    {
+                        int sum = src.data[((size_t)y0 * src.width + x0) * components + c] + src.data[((size_t)y0 * src.width + x1) * components + c]
+                                + src.data[((size_t)y1 * src.width + x0) * components + c] + src.data[((size_t)y1 * src.width + x1) * components + c];
+                        dst.data[((size_t)y * dst.width + x) * components + c] = (unsigned char)((sum + 2) / 4);
+                    }
+                }
+            }
+            chain.push_back(std::move(dst));
+        }
+        return chain;
+    }
+
+    static std::vector<unsigned char> Compress(const ImageLevel& level, int components, GLenum format)
+    {
+        int blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+        size_t blockBytes = format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 16 : 8;
+        std::vector<unsigned char> out((size_t)blocksX * blocksY * blockBytes);
+        unsigned char* dst = out.data();
+        unsigned char block[16][4];
+        for (int by = 0; by < blocksY; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                // gather the 4x4 block as RGBA, clamping at the image edge
+                for (int i = 0; i < 16; i++)
+                {
+                    int x = std::min(bx * 4 + (i & 3), level.width - 1);
+                    int y = std::min(by * 4 + (i >> 2), level.height - 1);
+                    const unsigned char* p = &level.data[((size_t)y * level.width + x) * components];
+                    block[i][0] = p[0];
+                    block[i][1] = components >= 3 ? p[1] : p[0];
+                    block[i][2] = components >= 3 ? p[2] : p[0];
+                    block[i][3] = components == 4 ? p[3] : 255;
+                }
+                if (format == GL_COMPRESSED_RED_RGTC1)
+                    CompressAlphaBlock(block, 0, dst);
+                else if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+                {
+                    CompressAlphaBlock(block, 3, dst);
+                    CompressColorBlock(block, dst + 8);
+                }
+                else
+                    CompressColorBlock(block, dst);
+                dst += blockBytes;
+            }
+        }
+        return out;
+    }
+
+    static uint16_t To565(const float c[3])
+    {
+        int r = std::min(31, std::max(0, (int)(c[0] * 31.0f / 255.0f + 0.5f)));
+        int g = std::min(63, std::max(0, (int)(c[1] * 63.0f / 255.0f + 0.5f)));
+        int b = std::min(31, std::max(0, (int)(c[2] * 31.0f / 255.0f + 0.5f)));
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    static void From565(uint16_t v, int c[3])
+    {
+        c[0] = ((v >> 11) & 31) * 255 / 31;
+        c[1] = ((v >> 5) & 63) * 255 / 63;
+        c[2] = (v & 31) * 255 / 31;
+    }
+
+    // BC1 color block: endpoints at the extremes of the block along its principal axis, then the
+    // nearest of the four palette entries per pixel. Always uses the 4-color mode (c0 > c1).
+    static void CompressColorBlock(const unsigned char block[16][4], unsigned char* out)
+    {
+        float mean[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 3; c++) mean[c] += block[i][c] / 16.0f;
+        float cov[6] = { 0, 0, 0, 0, 0, 0 };
+        for (int i = 0; i < 16; i++)
+        {
+            float d[3] = { block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2] };
+            cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+        }
+        // principal axis by power iteration
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[3] = { cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                              cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                              cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2] };
+            float length = std::max(std::max(std::abs(next[0]), std::abs(next[1])), std::abs(next[2]));
+            if (length <= 0.0f) break;
+            for (int c = 0; c < 3; c++) axis[c] = next[c] / length;
+        }
+        int minIndex = 0, maxIndex = 0;
+        float minDot = 1e30f, maxDot = -1e30f;
+        for (int i = 0; i < 16; i++)
+        {
+            float dot = block[i][0] * axis[0] + block[i][1] * axis[1] + block[i][2] * axis[2];
+            if (dot < minDot) { minDot = dot; minIndex = i; }
+            if (dot > maxDot) { maxDot = dot; maxIndex = i; }
+        }
+        float high[3] = { (float)block[maxIndex][0], (float)block[maxIndex][1], (float)block[maxIndex][2] };
+        float low[3] = { (float)block[minIndex][0], (float)block[minIndex][1], (float)block[minIndex][2] };
+        uint16_t c0 = To565(high), c1 = To565(low);
+        if (c0 < c1) std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if (c0 != c1)
+        {
+            int palette[4][3];
+            From565(c0, palette[0]);
+            From565(c1, palette[1]);
+            for (int c = 0; c < 3; c++)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0, bestError = 1 << 30;
+                for (int p = 0; p < 4; p++)
+                {
+                    int error = 0;
+                    for (int c = 0; c < 3; c++)
+                    {
+                        int d = block[i][c] - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) { bestError = error; best = p; }
+                }
+                indices |= (uint32_t)best << (2 * i);
+            }
+        }
+        out[0] = c0 & 0xFF; out[1] = c0 >> 8;
+        out[2] = c1 & 0xFF; out[3] = c1 >> 8;
+        for (int b = 0; b < 4; b++) out[4 + b] = (indices >> (8 * b)) & 0xFF;
+    }
+
+    // BC3 alpha / BC4 block for one channel: min and max as endpoints in the 8-value mode
+    static void CompressAlphaBlock(const unsigned char block[16][4], int channel, unsigned char* out)
+    {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            a0 = std::max(a0, (int)block[i][channel]);
+            a1 = std::min(a1, (int)block[i][channel]);
+        }
+        uint64_t indices = 0;
+        if (a0 > a1)
+        {
+            int palette[8] = { a0, a1 };
+            for (int p = 1; p < 7; p++)
+                palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0, bestError = 1 << 30;
+                for (int p = 0; p < 8; p++)
+                {
+                    int error = std::abs(block[i][channel] - palette[p]);
+                    if (error < bestError) { bestError = error; best = p; }
+                }
+                indices |= (uint64_t)best << (3 * i);
+            }
+        }
+        out[0] = (unsigned char)a0;
+        out[1] = (unsigned char)a1;
+        for (int b = 0; b < 6; b++) out[2 + b] = (indices >> (8 * b)) & 0xFF;
+    }
+};
+#endif
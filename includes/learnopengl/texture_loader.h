@@ -0,0 +1,158 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// one mip level, either 8-bit pixels or compressed blocks
+struct ImageLevel
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> data;
+};
+
+// Image in memory, ready for upload. Straight from an image file it is a single level of 8-bit
+// pixels; from the texture cache (texture_cache.h) it carries its whole mip chain, possibly block
+// compressed. Producing one touches no GL state, so it can happen on any thread; the levels are
+// freed when the last copy of the image goes away.
+struct DecodedImage
+{
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int components = 0;
+    GLenum compressedFormat = 0; // GL_COMPRESSED_* of every level, 0 for plain pixels
+    std::shared_ptr<const std::vector<ImageLevel>> levels;
+
+    bool Valid() const { return levels && !levels->empty(); }
+
+    size_t ByteSize() const
+    {
+        size_t bytes = 0;
+        if (levels)
+            for (const ImageLevel& level : *levels)
+                bytes += level.data.size();
+        return bytes;
+    }
+
+    GLenum Format() const
+    {
+        if (components == 1) return GL_RED;
+        if (components == 2) return GL_RG;
+        if (components == 3) return GL_RGB;
+        return GL_RGBA;
+    }
+};
+
+// thread safe as long as stbi_set_flip_vertically_on_load is not changed while decoding
+inline DecodedImage DecodeImage(const std::string& path)
+{
+    DecodedImage image;
+    image.path = path;
+    unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &image.components, 0);
+    if (data)
+    {
+        auto levels = std::make_shared<std::vector<ImageLevel>>(1);
+        ImageLevel& level = levels->front();
+        level.width = image.width;
+        level.height = image.height;
+        level.data.assign(data, data + (size_t)image.width * image.height * image.components);
+        image.levels = levels;
+    }
+    else
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+    stbi_image_free(data);
+    return image;
+}
+
+// Creates mipmapped 2D textures from images on the GL thread. Single-level images get their mips
+// from glGenerateMipmap, images with a precomputed chain upload every level as is. With
+// pixelBuffer set all levels are staged in a pixel unpack buffer (orphaned per upload) so the
+// glTexImage2D calls source them from driver memory and can return before the transfer finishes;
+// without it they are passed straight from client memory.
+class TextureUploader
+{
+public:
+    explicit TextureUploader(bool pixelBuffer = true) : pixelBuffer(pixelBuffer) {}
+
+    // an invalid image still yields a texture name, left without storage, like TextureFromFile
+    unsigned int Upload(const DecodedImage& image, GLint wrap = GL_REPEAT)
+    {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        if (!image.Valid()) return textureID;
+
+        const std::vector<ImageLevel>& levels = *image.levels;
+        GLenum format = image.Format();
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        bool staged = pixelBuffer && Stage(image);
+        size_t offset = 0;
+        for (int i = 0; i < (int)levels.size(); i++)
+        {
+            const ImageLevel& level = levels[i];
+            const void* source = staged ? (const void*)offset : (const void*)level.data.data();
+            if (image.compressedFormat)
+                glCompressedTexImage2D(GL_TEXTURE_2D, i, image.compressedFormat, level.width, level.height, 0, (GLsizei)level.data.size(), source);
+            else
+                glTexImage2D(GL_TEXTURE_2D, i, format, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, source);
+            offset += level.data.size();
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (levels.size() > 1)
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+        else
+            glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return textureID;
+    }
+
+    void Release()
+    {
+        if (PBO) glDeleteBuffers(1, &PBO);
+        PBO = 0;
+    }
+
+private:
+    bool pixelBuffer;
+    unsigned int PBO = 0;
+
+    // copies every level back to back into a fresh store of the unpack buffer and leaves it bound
+    bool Stage(const DecodedImage& image)
+    {
+        size_t size = image.ByteSize();
+        if (!PBO) glGenBuffers(1, &PBO);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        unsigned char* mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (!mapped)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return false;
+        }
+        for (const ImageLevel& level : *image.levels)
+        {
+            std::memcpy(mapped, level.data.data(), level.data.size());
+            mapped += level.data.size();
+        }
+        if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return false;
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,196 @@
+#ifndef TEXTURE_REGISTRY_H
+#define TEXTURE_REGISTRY_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/texture_cache.h>
+#include <learnopengl/texture_loader.h>
+#include <learnopengl/thread_pool.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Process-wide owner of every texture loaded from an image file, decoded through TextureCache.
+// Requests are keyed by the normalized path, so "textures/./brickwall.jpg" and
+// "textures/brickwall.jpg" share one decode; the GL texture itself is keyed by a hash of the
+// decoded image plus its wrap mode, so identical images stored under different names also share
+// one texture. Textures are reference counted:
+// every Acquire() needs a matching Release(), the last one deletes the texture.
+// Prefetch() may be called from any thread, Acquire() and Release() only on the GL thread.
+class TextureRegistry
+{
+public:
+    using WrapRule = std::function<GLint(const DecodedImage&)>;
+
+    static TextureRegistry& Shared()
+    {
+        static TextureRegistry registry;
+        return registry;
+    }
+
+    static std::string Normalize(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    // starts decoding path unless it is already decoded or being decoded; decodes on the calling
+    // thread without a pool
+    void Prefetch(const std::string& path, ThreadPool* pool = nullptr)
+    {
+        std::string key = Normalize(path);
+        std::promise<HashedImage> promise;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (images.count(key)) return;
+            Image& image = images[key];
+            if (pool)
+            {
+                image.decoded = pool->Submit([key] { return Decode(key); }).share();
+                return;
+            }
+            image.decoded = promise.get_future().share();
+        }
+        promise.set_value(Decode(key));
+    }
+
+    // texture for path with one more reference. wrapFor picks the wrap mode from the image
+    // (GL_REPEAT when not given); a different mode for the same image is a separate texture
+    unsigned int Acquire(const std::string& path, TextureUploader& uploader, const WrapRule& wrapFor = nullptr)
+    {
+        std::string key = Normalize(path);
+        Prefetch(key);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        Image& image = images[key]; // map elements stay put while other keys are added
+        if (!image.described)
+        {
+            // wait without the lock: the decode may still be queued behind a worker that is
+            // blocked in Prefetch() on this same mutex
+            std::shared_future<HashedImage> pending = image.decoded;
+            lock.unlock();
+            const HashedImage& decoded = pending.get();
+            lock.lock();
+            if (!image.described)
+            {
+                image.info = decoded.image;
+                image.info.levels.reset();
+                image.contentHash = decoded.hash;
+                image.described = true;
+            }
+        }
+
+        GLint wrap = wrapFor ? wrapFor(image.info) : GL_REPEAT;
+        TextureKey textureKey{ image.contentHash, wrap };
+        auto existing = textures.find(textureKey);
+        if (existing != textures.end())
+        {
+            image.decoded = std::shared_future<HashedImage>();
+            existing->second.references++;
+            return existing->second.id;
+        }
+
+        // pixels were dropped after the first upload, another wrap mode of the same image decodes again
+        if (!image.decoded.valid())
+        {
+            std::promise<HashedImage> again;
+            again.set_value(Decode(key));
+            image.decoded = again.get_future().share();
+        }
+        unsigned int id = uploader.Upload(image.decoded.get().image, wrap);
+        image.decoded = std::shared_future<HashedImage>();
+        textures[textureKey] = Resident{ id, 1 };
+        keysById[id] = textureKey;
+        return id;
+    }
+
+    void Release(unsigned int id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto key = keysById.find(id);
+        if (key == keysById.end()) return;
+        auto texture = textures.find(key->second);
+        if (--texture->second.references > 0) return;
+        glDeleteTextures(1, &id);
+        textures.erase(texture);
+        keysById.erase(key);
+    }
+
+    // live GL textures
+    size_t Size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return textures.size();
+    }
+
+private:
+    struct HashedImage
+    {
+        DecodedImage image;
+        uint64_t hash = 0;
+    };
+
+    struct Image
+    {
+        std::shared_future<HashedImage> decoded;  // empty once uploaded
+        DecodedImage info;                        // size and format, no pixels
+        uint64_t contentHash = 0;
+        bool described = false;
+    };
+
+    struct TextureKey
+    {
+        uint64_t contentHash;
+        GLint wrap;
+        bool operator==(const TextureKey& other) const { return contentHash == other.contentHash && wrap == other.wrap; }
+    };
+
+    struct TextureKeyHash
+    {
+        size_t operator()(const TextureKey& key) const { return (size_t)(key.contentHash ^ ((uint64_t)key.wrap * 0x9E3779B97F4A7C15ull)); }
+    };
+
+    struct Resident
+    {
+        unsigned int id;
+        int references;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Image> images;
+    std::unordered_map<TextureKey, Resident, TextureKeyHash> textures;
+    std::unordered_map<unsigned int, TextureKey> keysById;
+
+    // transcoded (or cached) mip chain and content hash, both on the decoding thread
+    static HashedImage Decode(const std::string& path)
+    {
+        HashedImage result;
+        result.image = TextureCache::Load(path);
+        result.hash = HashImage(result.image);
+        return result;
+    }
+
+    // FNV-1a over size, format and the base level. images that failed to decode hash their path
+    // instead, so two missing files never alias
+    static uint64_t HashImage(const DecodedImage& image)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const unsigned char* bytes, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+        };
+        uint32_t header[4] = { (uint32_t)image.width, (uint32_t)image.height, (uint32_t)image.components, image.compressedFormat };
+        mix(reinterpret_cast<const unsigned char*>(header), sizeof(header));
+        if (image.Valid())
+            mix(image.levels->front().data.data(), image.levels->front().data.size());
+        else
+            mix(reinterpret_cast<const unsigned char*>(image.path.data()), image.path.size());
+        return hash;
+    }
+};
+#endif
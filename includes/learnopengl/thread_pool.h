@@ -0,0 +1,143 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one FIFO queue. Submit() runs a task asynchronously and
+// returns its future; ParallelFor() splits an index range over the workers and the calling
+// thread and only returns once every index has been processed.
+class ThreadPool
+{
+public:
+    // threadCount 0 picks one worker per hardware thread, minus the calling (main) thread
+    explicit ThreadPool(unsigned int threadCount = 0)
+    {
+        if (threadCount == 0)
+        {
+            unsigned int hardware = std::thread::hardware_concurrency();
+            threadCount = hardware > 1 ? hardware - 1 : 1;
+        }
+        for (unsigned int i = 0; i < threadCount; i++)
+            workers.emplace_back([this] { WorkerLoop(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int Size() const { return (unsigned int)workers.size(); }
+
+    template <typename F>
+    auto Submit(F&& task) -> std::future<decltype(task())>
+    {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([packaged] { (*packaged)(); });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    // calls body(i) for every i in [0, count); indices are handed out one at a time so uneven
+    // work (e.g. skeletons of different sizes) still balances across threads. if body throws, no
+    // further indices are started and the first exception is rethrown once every thread is done
+    void ParallelFor(int count, const std::function<void(int)>& body)
+    {
+        if (count <= 0) return;
+        if (count == 1 || workers.empty())
+        {
+            for (int i = 0; i < count; i++) body(i);
+            return;
+        }
+
+        std::atomic<int> next(0);
+        auto drain = [&]
+        {
+            try
+            {
+                for (int i = next++; i < count; i = next++)
+                    body(i);
+            }
+            catch (...)
+            {
+                next = count;
+                throw;
+            }
+        };
+        int helpers = std::min((int)workers.size(), count - 1);
+        std::vector<std::future<void>> pending;
+        pending.reserve(helpers);
+        for (int i = 0; i < helpers; i++)
+            pending.push_back(Submit(drain));
+        // the helpers reference next and drain on this stack, so wait for all of them before
+        // leaving, even when something threw
+        std::exception_ptr error;
+        try
+        {
+            drain();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        for (std::future<void>& f : pending)
+        {
+            try
+            {
+                f.get();
+            }
+            catch (...)
+            {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void WorkerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+#endif
@@ -7,7 +7,6 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
-#include <glm/gtc/random.hpp>
 
  // --- Game Engine Headers (LearnOpenGL) ---
 #include <learnopengl/filesystem.h>
@@ -16,6 +15,19 @@
 #include <learnopengl/model.h>
 #include <learnopengl/animator.h>
 #include <learnopengl/animation.h>
+#include <learnopengl/level_mesh.h>
+#include <learnopengl/frustum.h>
+#include <learnopengl/level_visibility.h>
+#include <learnopengl/render_queue.h>
+#include <learnopengl/instance_buffer.h>
+#include <learnopengl/gpu_profiler.h>
+#include <learnopengl/gpu_particles.h>
+#include <learnopengl/spatial_grid.h>
+#include <learnopengl/frame_uniforms.h>
+#include <learnopengl/bone_palette.h>
+#include <learnopengl/animation_system.h>
+#include <learnopengl/import_cache.h>
+#include <learnopengl/asset_loader.h>
 
 #include <iostream>
 #include <vector>
@@ -72,6 +84,9 @@ float recoilTimer = 0.0f;
 float currentRecoilZ = 0.0f; // Backward kick
 float currentRecoilX = 0.0f; // Upward muzzle climb
 
+// --- Profiling ---
+GpuProfiler gpuProfiler; // GPU time per render section, toggled with F3 (also gates the render stats output)
+
 // --- Map Objects ---
 int totalBarrels = 0;
 int destroyedBarrels = 0;
@@ -80,14 +95,6 @@ int destroyedBarrels = 0;
 // DATA STRUCTURES
 // ==========================================================================================
 
-struct Particle {
-    glm::vec3 Position;
-    glm::vec3 Velocity;
-    glm::vec4 Color;
-    float Life;
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) {}
-};
-
 struct Hunter {
     glm::vec3 Position;
     float BaseSpeed;
@@ -127,10 +134,17 @@ std::vector<glm::vec3> barrelPositions;
 std::vector<bool> barrelVisible;
 const float barrelModelScale = 0.04f;
 const float barrelRadius = 0.8f; // Hitbox size
-
-std::vector<Particle> particles;
+const float characterBoundsPadding = 1.0f; // Room for animated limbs around the bind pose bounds
+LevelVisibility levelVisibility; // Potentially visible chunks, tiles & barrels per cell cluster
+InstanceBuffer barrelInstances; // Transforms of the live barrels that passed culling
+std::vector<glm::mat4> barrelTransforms; // Model matrix per barrel, barrels never move
+std::vector<BoundingBox> barrelBounds; // World bounds per barrel
+SpatialGrid barrelGrid; // Live barrels bucketed per level tile, for collision & hit tests
+
+GpuParticles particles; // Simulated on the GPU, chain reactions reuse the oldest slots when full
+const int particleCapacity = 65536;
 unsigned int nr_new_particles = 100;
-unsigned int particleVAO, particleVBO;
+const GpuParticles::Burst barrelBurst{ 0.5f, 2.0f, 1.0f, glm::vec4(1.0f, 0.5f, 0.0f, 1.0f), 1.0f }; // Orange sparks thrown upwards
 
 // --- Level Design (6-Layer Gauntlet) ---
 // '#' = Wall, '.' = Floor, 'B' = Destructible Barrel
@@ -184,12 +198,14 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void processInput(GLFWwindow* window);
-unsigned int loadTexture(const char* path);
+GLint TextureWrapFor(const DecodedImage& image);
 bool CheckLineOfSight(glm::vec3 start, glm::vec3 end, const std::vector<std::string>& map);
 void SpawnParticles(glm::vec3 position);
 void UpdateParticles(float dt);
 void RenderCrosshair(Shader& shader, unsigned int vao);
+void LogAnimationCompression(const char* clip, const CompressionReport& report);
 
 // ==========================================================================================
 // MAIN FUNCTION
@@ -213,6 +229,7 @@ int main()
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetKeyCallback(window, key_callback);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     // --- 2. Init GLAD ---
@@ -220,66 +237,116 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // Block compressed textures are cached only when the driver can sample them
+    TextureCache::DetectSupport();
+    // Linked shader programs are reused across runs when the driver can hand them back
+    Shader::EnableProgramBinaryCache((GLADloadproc)glfwGetProcAddress);
+
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    // Worker threads for parallel per-frame work (animation)
+    ThreadPool workerPool;
+
     // --- 3. Compile Shaders ---
     Shader ourShader("shaders/static_model.vs", "shaders/static_model.fs");
     Shader floorShader("shaders/static_model.vs", "shaders/static_model.fs");
+    Shader barrelShader("shaders/static_model_instanced.vs", "shaders/static_model.fs");
     Shader skinningShader("shaders/skinning.vs", "shaders/skinning.fs");
     Shader particleShader("shaders/particle.vs", "shaders/particle.fs");
+    Shader particleUpdateShader("shaders/particle_update.vs", { "PositionLife", "Velocity", "Color" });
     Shader laserShader("shaders/laser.vs", "shaders/laser.fs");
     Shader crosshairShader("shaders/crosshair.vs", "shaders/crosshair.fs");
 
+    // Camera & light state lives in one uniform buffer shared by every program
+    FrameUniforms frameUniforms;
+    frameUniforms.Init();
+    for (Shader* shader : { &ourShader, &floorShader, &barrelShader, &skinningShader, &particleShader, &laserShader })
+        shader->bindUniformBlock(FrameUniforms::BLOCK_NAME, FrameUniforms::BINDING);
+
+    // Bone palettes of all skinned characters share one texture buffer
+    BonePalette bonePalette;
+    bonePalette.Init();
+    skinningShader.use();
+    skinningShader.setInt(BonePalette::SAMPLER_NAME, BonePalette::TEXTURE_UNIT);
+
+    // Uniforms written inside per-object loops are resolved once here
+    Shader::Uniform<glm::mat4> skinModelUniform = skinningShader.uniform<glm::mat4>("model");
+    Shader::Uniform<int> skinBoneOffsetUniform = skinningShader.uniform<int>("boneOffset");
+    Shader::Uniform<int> skinBoneCountUniform = skinningShader.uniform<int>("boneCount");
+    Shader::Uniform<float> particleViewportUniform = particleShader.uniform<float>("viewportHeight");
+    particleShader.use();
+    particleShader.setFloat("particleSize", 0.2f);
+
     stbi_set_flip_vertically_on_load(true);
 
-    // --- 4. Load Models & Animations ---
-    Model doorFrameModel("objects/kit/doorframe.obj");
-    Model barrelModel("objects/Barrel/Barrels_OBJ.obj");
+    // --- 4. Load Models, Animations & Textures ---
+    // Imports, decodes and clip processing run on the worker pool, this thread only uploads
+    AssetLoader loader(workerPool);
+    loader.SetProgressCallback([](int completed, int total, const std::string& label) {
+        std::cout << "LOADING [" << completed << "/" << total << "] " << label << std::endl;
+    });
+
+    Model doorFrameModel, barrelModel, gunModel, hunterModel;
+    Animation gunIdleAnim, runAnim, jumpAnim;
+    loader.AddModel(doorFrameModel, "objects/kit/doorframe.obj");
+    loader.AddModel(barrelModel, "objects/Barrel/Barrels_OBJ.obj");
 
     // Gun Model (Collada .dae for animation support)
-    Model gunModel("objects/airgun/Air_Gun-COLLADA_2.dae");
+    // the idle clip lives in the same file, loading it right away reuses the imported scene
+    loader.AddModel(gunModel, "objects/airgun/Air_Gun-COLLADA_2.dae", [&]() {
+        gunIdleAnim = Animation("objects/airgun/Air_Gun-COLLADA_2.dae", &gunModel);
+    });
+
+    // Hunter Animation (long clips, resampled to 30 fps so sampling is a direct lookup)
+    // clips add their missing bones to the model in order, so they load after it in the same job
+    loader.AddModel(hunterModel, "objects/hunter/Ch43_nonPBR.dae", [&]() {
+        runAnim = Animation("objects/hunter/Run Forward.dae", &hunterModel, 30.0f);
+        jumpAnim = Animation("objects/hunter/Jump.dae", &hunterModel, 30.0f);
+    });
+
+    // the registry hands out one texture per image, the brick wall is decoded and uploaded once
+    unsigned int floorTexture, wallTexture, doorTexture, barrelTexture, gunTexture;
+    loader.AddTexture(floorTexture, "textures/brickwall.jpg", TextureWrapFor);
+    loader.AddTexture(wallTexture, "textures/brickwall.jpg", TextureWrapFor);
+    loader.AddTexture(doorTexture, "textures/brickwall.jpg", TextureWrapFor);
+    loader.AddTexture(barrelTexture, "objects/Barrel/Barrels_MainBody_BaseColor.png", TextureWrapFor);
+    loader.AddTexture(gunTexture, "objects/airgun/Air_Gun_Default_color.png.002.jpg", TextureWrapFor);
+
+    loader.Finish();
+    // every source file is loaded, drop the parsed scenes
+    ImportCache::Shared().Clear();
 
-    // Hunter Animation
-    Model hunterModel("objects/hunter/Ch43_nonPBR.dae");
-    Animation runAnim("objects/hunter/Run Forward.dae", &hunterModel);
-    Animation jumpAnim("objects/hunter/Jump.dae", &hunterModel);
+    Animator gunAnimator(&gunIdleAnim);
     Animator animator(&runAnim);
 
-    // Gun Animation
-    Animation gunIdleAnim("objects/airgun/Air_Gun-COLLADA_2.dae", &gunModel);
-    Animator gunAnimator(&gunIdleAnim);
+    // Compress clip storage once everything that needs names / the node tree has loaded
+    LogAnimationCompression("Run Forward", runAnim.Compress());
+    LogAnimationCompression("Jump", jumpAnim.Compress());
+    LogAnimationCompression("Gun Idle", gunIdleAnim.Compress());
+
+    // All skinned characters are evaluated together on the worker threads each frame.
+    // Palette sizes are the bones each skeleton actually uses (animations may add bones to the model)
+    AnimationSystem animationSystem(workerPool);
+    int hunterCharacter = animationSystem.Add(&animator, hunterModel.GetBoneCount());
+    int gunCharacter = animationSystem.Add(&gunAnimator, gunModel.GetBoneCount());
+
+    // Hunter Animation LOD: full rate up close, then sparser updates without finger / hand bones
+    animator.SetLodBands({
+        { 20.0f, 0.0f, -1 },
+        { 50.0f, 1.0f / 15.0f, 9 },
+        { 1000.0f, 1.0f / 6.0f, 7 },
+    });
 
     // Link global pointers
     globalGunAnimator = &gunAnimator;
     globalGunFireAnim = &gunIdleAnim;
 
-    // --- 5. Load Textures ---
-    unsigned int floorTexture = loadTexture("textures/brickwall.jpg");
-    unsigned int wallTexture = loadTexture("textures/brickwall.jpg");
-    unsigned int doorTexture = loadTexture("textures/brickwall.jpg");
-    unsigned int barrelTexture = loadTexture("objects/Barrel/Barrels_MainBody_BaseColor.png");
-    unsigned int gunTexture = loadTexture("objects/airgun/Air_Gun_Default_color.png.002.jpg");
-
-    // --- 6. Setup Vertex Data (Cube, Laser, Crosshair, Particles) ---
-    // (Cube Vertices for Map Building)
-    float cubeVertices[] = {
-        -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f, 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f, 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f, 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f, -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f, -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f, 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f, 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f, 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f, -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f, -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
-        -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f, -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f, -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f, -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f, -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f, -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f, 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f, 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f, 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f, 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f, 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f, 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f, 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f, -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f, -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f, 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f, -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f, -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
-    };
-    unsigned int cubeVAO, cubeVBO;
-    glGenVertexArrays(1, &cubeVAO); glGenBuffers(1, &cubeVBO);
-    glBindVertexArray(cubeVAO); glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(2); glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glBindVertexArray(0);
+    // --- 5. Setup Vertex Data (Level, Laser, Crosshair, Particles) ---
+    // (Walls and floor are baked once into merged static batches)
+    LevelMesh levelMesh;
+    levelMesh.Bake(levelLayout, TILE_SIZE);
 
     // Laser Lines
     unsigned int laserVAO, laserVBO;
@@ -299,29 +366,71 @@ int main()
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    // VFX: Particles
-    glGenVertexArrays(1, &particleVAO); glGenBuffers(1, &particleVBO);
-    glBindVertexArray(particleVAO); glBindBuffer(GL_ARRAY_BUFFER, particleVBO);
-    float particleQuad[] = { 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f };
-    glBufferData(GL_ARRAY_BUFFER, sizeof(particleQuad), particleQuad, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindVertexArray(0);
+    // VFX: Particles (transform feedback ping-pong buffers, drawn as point sprites)
+    particles.Init(particleCapacity, particleUpdateShader);
+    glEnable(GL_PROGRAM_POINT_SIZE);
 
-    // --- 7. Initialize Game Entities ---
+    // --- 6. Initialize Game Entities ---
     barrelPositions.clear(); barrelVisible.clear(); totalBarrels = 0;
+    size_t levelWidth = 0;
+    for (const std::string& row : levelLayout) levelWidth = std::max(levelWidth, row.size());
+    barrelGrid.Init((int)levelWidth, (int)levelLayout.size(), TILE_SIZE);
     for (int z = 0; z < levelLayout.size(); z++) {
         for (int x = 0; x < levelLayout[z].size(); x++) {
             if (levelLayout[z][x] == 'B') {
                 barrelPositions.push_back(glm::vec3(x * TILE_SIZE, 0.0f, z * TILE_SIZE));
                 barrelVisible.push_back(true);
+                barrelGrid.Insert(totalBarrels, barrelPositions.back(), barrelRadius);
                 totalBarrels++;
             }
         }
     }
 
+    // Precompute what can be seen from each cell cluster, walls occlude everything behind them
+    levelVisibility.Bake(levelLayout, TILE_SIZE, levelMesh, barrelPositions, &workerPool);
+    int pvsClusters = 0, pvsChunks = 0;
+    for (int cluster = 0; cluster < levelVisibility.ClusterCount(); cluster++) {
+        if (!levelVisibility.Baked(cluster)) continue;
+        pvsClusters++;
+        pvsChunks += levelVisibility.VisibleChunks(cluster);
+    }
+    std::cout << "LEVEL::PVS " << pvsClusters << " clusters, " << levelVisibility.ByteSize() << " bytes, "
+              << (pvsClusters ? pvsChunks / pvsClusters : 0) << " of " << levelMesh.chunks.size() << " chunks visible on average" << std::endl;
+
+    // All barrels share one draw call per mesh, their model matrices come from an instance buffer
+    barrelInstances.Init(totalBarrels);
+    barrelModel.SetInstanceBuffer(barrelInstances);
+    barrelTransforms.clear(); barrelBounds.clear();
+    for (const glm::vec3& position : barrelPositions) {
+        glm::mat4 bModel = glm::mat4(1.0f);
+        bModel = glm::translate(bModel, position);
+        bModel = glm::scale(bModel, glm::vec3(barrelModelScale));
+        barrelTransforms.push_back(bModel);
+        barrelBounds.push_back(barrelModel.bounds.Transformed(bModel));
+    }
+    std::vector<int> barrelsInView;
+    std::vector<glm::mat4> barrelsInViewTransforms;
+
     glm::vec3 lightDirection = glm::vec3(0.5f, -0.2f, -1.0f);
     glm::vec3 ambientLight = glm::vec3(0.5f);
 
+    // Frustum culling counters, averaged per frame and logged every few seconds
+    CullStats cullStats;
+    unsigned long cullSubmittedTotal = 0, cullCulledTotal = 0, cullOccludedTotal = 0, cullFrames = 0;
+    float cullReportTimer = 0.0f;
+
+    // World and particle draws go through a sorted queue that skips redundant binds
+    RenderQueue renderQueue;
+
+    // GPU timers around each render section (the sorted world flush covers walls, floor & barrels)
+    int worldSection = gpuProfiler.AddSection("world");
+    int gunSection = gpuProfiler.AddSection("gun");
+    int hunterSection = gpuProfiler.AddSection("hunter");
+    int laserSection = gpuProfiler.AddSection("laser");
+    int particleSection = gpuProfiler.AddSection("particles");
+    int crosshairSection = gpuProfiler.AddSection("crosshair");
+    gpuProfiler.Init();
+
     // ==========================================================================================
     // GAME LOOP
     // ==========================================================================================
@@ -335,8 +444,6 @@ int main()
 
         // 2. Input & Physics Update
         processInput(window);
-        animator.UpdateAnimation(deltaTime);
-        gunAnimator.UpdateAnimation(deltaTime);
 
         // 3. Recoil Physics (Spring Back)
         if (recoilTimer > 0.0f) {
@@ -353,7 +460,6 @@ int main()
             laserTimer += deltaTime;
             if (laserTimer >= laserDuration) { isShooting = false; laserTimer = 0.0f; }
         }
-        UpdateParticles(deltaTime);
 
         // 4. Game Logic (Win/Loss)
         if (!isGameOver && !isGameWon) {
@@ -440,6 +546,8 @@ int main()
         // RENDER PIPELINE
         // ======================================================================================
 
+        gpuProfiler.BeginFrame();
+
         // 1. Clear Screen (Background Color Logic)
         if (isGameOver) glClearColor(0.5f, 0.0f, 0.0f, 1.0f); // Red (Death)
         else if (isGameWon) glClearColor(0.8f, 0.6f, 0.0f, 1.0f); // Gold (Win)
@@ -450,93 +558,93 @@ int main()
         glm::mat4 projection = glm::perspective(glm::radians(100.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 500.0f);
         glm::mat4 view = camera.GetViewMatrix();
 
-        // 2. Render Walls
-        ourShader.use();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
-        ourShader.setVec3("light.direction", camera.Front);
-        ourShader.setVec3("viewPos", camera.Position);
-        ourShader.setVec3("light.ambient", ambientLight);
-        ourShader.setVec3("light.diffuse", glm::vec3(0.8f));
-        ourShader.setVec3("light.specular", glm::vec3(0.2f));
-
-        for (int z = 0; z < levelLayout.size(); z++) {
-            for (int x = 0; x < levelLayout[z].size(); x++) {
-                char tile = levelLayout[z][x];
-                glm::vec3 tilePos(x * TILE_SIZE, 0.0f, z * TILE_SIZE);
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::translate(model, tilePos);
-
-                if (tile == '#' || tile == '-' || tile == '|') {
-                    if (tile == '|') model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0, 1, 0));
-                    model = glm::translate(model, glm::vec3(0, 6.0f, 0));
-                    model = glm::scale(model, glm::vec3(TILE_SIZE, 12.0f, 0.5f)); // Tall Walls
-                    if (tile == '#') model = glm::scale(model, glm::vec3(1.0f, 1.0f, 8.0f));
-                    ourShader.setMat4("model", model);
-                    glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, wallTexture);
-                    glBindVertexArray(cubeVAO); glDrawArrays(GL_TRIANGLES, 0, 36);
-                }
-            }
+        FrameData frameData;
+        frameData.projection = projection;
+        frameData.view = view;
+        frameData.viewPos = glm::vec4(camera.Position, 1.0f);
+        frameData.lightDirection = glm::vec4(lightDirection, 0.0f);
+        frameData.lightAmbient = glm::vec4(ambientLight, 1.0f);
+        frameData.lightDiffuse = glm::vec4(glm::vec3(0.8f), 1.0f);
+        frameData.lightSpecular = glm::vec4(glm::vec3(0.2f), 1.0f);
+        frameUniforms.Update(frameData);
+
+        // Level chunks, barrels and the hunter are limited to the potentially visible set of the
+        // camera's cell, then tested against the view frustum before submission
+        Frustum frustum(projection * view);
+        cullStats.Reset();
+        int viewCluster = levelVisibility.ClusterAt(camera.Position);
+        const uint64_t* visibleChunks = levelVisibility.ChunkBits(viewCluster);
+
+        // Hunter placement & culling come before animating, so its LOD sees the same visibility
+        // the draw uses: a hunter that is not drawn skips pose evaluation, a drawn one never
+        // shows a stale pose
+        glm::mat4 hModel = glm::mat4(1.0f);
+        hModel = glm::translate(hModel, hunter.Position);
+        glm::vec3 faceDir;
+        if (hunter.IsJumping) faceDir = hunter.JumpDirection; else faceDir = glm::normalize(camera.Position - hunter.Position);
+
+        if (glm::length(faceDir) > 0.01f) {
+            float angle = atan2(faceDir.x, faceDir.z);
+            hModel = glm::rotate(hModel, angle, glm::vec3(0, 1, 0));
         }
-
-        // 3. Render Floor
-        floorShader.use();
-        floorShader.setMat4("projection", projection);
-        floorShader.setMat4("view", view);
-        floorShader.setVec3("light.direction", camera.Front);
-        floorShader.setVec3("viewPos", camera.Position);
-        floorShader.setVec3("light.ambient", ambientLight);
-
-        for (int z = 0; z < levelLayout.size(); z++) {
-            for (int x = 0; x < levelLayout[z].size(); x++) {
-                glm::vec3 tilePos(x * TILE_SIZE, 0.0f, z * TILE_SIZE);
-                glm::mat4 fmodel = glm::mat4(1.0f);
-                fmodel = glm::translate(fmodel, tilePos);
-                fmodel = glm::translate(fmodel, glm::vec3(0, -0.1f, 0));
-                fmodel = glm::scale(fmodel, glm::vec3(TILE_SIZE, 0.2f, TILE_SIZE));
-                floorShader.setMat4("model", fmodel);
-                glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, floorTexture);
-                glBindVertexArray(cubeVAO); glDrawArrays(GL_TRIANGLES, 0, 36);
-            }
+        hModel = glm::scale(hModel, glm::vec3(2.5f));
+        bool hunterInPvs = levelVisibility.TileVisible(viewCluster, hunter.Position);
+        bool hunterInView = hunterInPvs && frustum.Intersects(hunterModel.bounds.Transformed(hModel).Padded(characterBoundsPadding));
+
+        float hunterDistance = glm::distance(hunter.Position, camera.Position);
+        animator.SetLodState(hunterDistance, hunterInView);
+        animationSystem.SetActive(hunterCharacter, !isGameOver); // hunter is not drawn once the player died
+        animationSystem.Update(deltaTime, bonePalette);
+
+        // Opaque world geometry is queued, then drawn sorted by program, texture, VAO and depth
+        // 2. Walls
+        RenderQueue::DrawItem wallItem;
+        wallItem.program = ourShader.ID;
+        wallItem.texture = wallTexture;
+        wallItem.modelLocation = ourShader.getUniformLocation("model");
+        levelMesh.SubmitWalls(renderQueue, wallItem, frustum, &cullStats, visibleChunks);
+
+        // 3. Floor
+        RenderQueue::DrawItem floorItem;
+        floorItem.program = floorShader.ID;
+        floorItem.texture = floorTexture;
+        floorItem.modelLocation = floorShader.getUniformLocation("model");
+        levelMesh.SubmitFloor(renderQueue, floorItem, frustum, &cullStats, visibleChunks);
+
+        // 4. Barrels
+        // Every barrel in the PVS is frustum tested; the instance buffer is only uploaded again
+        // when the set that passed changes, shot barrels are removed from it one by one (see
+        // mouse_button_callback)
+        unsigned int barrelsInPvs = 0;
+        barrelsInView.clear();
+        levelVisibility.ForEachVisibleBarrel(viewCluster, [&](int i) {
+            barrelsInPvs++;
+            if (cullStats.Record(frustum.Intersects(barrelBounds[i]))) barrelsInView.push_back(i);
+        });
+        cullStats.occluded += (totalBarrels - destroyedBarrels) - barrelsInPvs;
+        if (!barrelInstances.Matches(barrelsInView)) {
+            barrelsInViewTransforms.clear();
+            for (int i : barrelsInView) barrelsInViewTransforms.push_back(barrelTransforms[i]);
+            barrelInstances.Assign(barrelsInView, barrelsInViewTransforms);
         }
+        barrelModel.SubmitInstanced(renderQueue, barrelShader.ID, barrelInstances.Count(), 0.0f, barrelTexture);
 
-        // 4. Render Barrels
-        ourShader.use();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
-        ourShader.setVec3("viewPos", camera.Position);
-        glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, barrelTexture);
-
-        for (size_t i = 0; i < barrelPositions.size(); ++i) {
-            if (barrelVisible[i]) {
-                glm::mat4 bModel = glm::mat4(1.0f);
-                bModel = glm::translate(bModel, barrelPositions[i]);
-                bModel = glm::scale(bModel, glm::vec3(barrelModelScale));
-                ourShader.setMat4("model", bModel);
-                barrelModel.Draw(ourShader);
-            }
-        }
+        gpuProfiler.Begin(worldSection);
+        renderQueue.Flush();
+        gpuProfiler.End(worldSection);
 
         // 5. Render Gun (First Person View)
         // Clear Depth buffer to ensure gun is drawn ON TOP of walls (Prevents clipping)
+        gpuProfiler.Begin(gunSection);
         glClear(GL_DEPTH_BUFFER_BIT);
 
+        // Palettes were written by the animation system, upload them in a single write
+        bonePalette.Upload();
+        bonePalette.Bind();
+
         skinningShader.use();
-        skinningShader.setMat4("projection", projection);
-        skinningShader.setMat4("view", view);
-        skinningShader.setVec3("light.direction", lightDirection);
-        skinningShader.setVec3("viewPos", camera.Position);
-        skinningShader.setVec3("light.ambient", ambientLight);
-        skinningShader.setVec3("light.diffuse", glm::vec3(0.8f));
-
-        auto gunTransforms = gunAnimator.GetFinalBoneMatrices();
-        for (int i = 0; i < gunTransforms.size(); ++i) {
-            skinningShader.setMat4("finalBonesMatrices[" + std::to_string(i) + "]", gunTransforms[i]);
-        }
-        glm::mat4 identityMatrix = glm::mat4(1.0f);
-        for (int i = gunTransforms.size(); i < 200; ++i) {
-            skinningShader.setMat4("finalBonesMatrices[" + std::to_string(i) + "]", identityMatrix);
-        }
+        skinBoneOffsetUniform.set(animationSystem.GetPaletteOffset(gunCharacter));
+        skinBoneCountUniform.set(animationSystem.GetBoneCount(gunCharacter));
 
         glm::mat4 gunMatrix = glm::mat4(1.0f);
         gunMatrix = glm::translate(gunMatrix, camera.Position);
@@ -553,38 +661,32 @@ int main()
         // Orientation Fix (Face Left)
         gunMatrix = glm::rotate(gunMatrix, glm::radians(270.0f), glm::vec3(0, 1, 0));
 
-        skinningShader.setMat4("model", gunMatrix);
+        skinModelUniform.set(gunMatrix);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gunTexture);
         gunModel.Draw(skinningShader);
+        gpuProfiler.End(gunSection);
 
         glEnable(GL_DEPTH_TEST); // Re-enable depth for the rest of the scene
 
         // 6. Render Hunter
         if (!isGameOver) {
-            auto transforms = animator.GetFinalBoneMatrices();
-            for (int i = 0; i < transforms.size(); ++i) skinningShader.setMat4("finalBonesMatrices[" + std::to_string(i) + "]", transforms[i]);
-            for (int i = transforms.size(); i < 200; ++i) skinningShader.setMat4("finalBonesMatrices[" + std::to_string(i) + "]", identityMatrix);
-
-            glm::mat4 hModel = glm::mat4(1.0f);
-            hModel = glm::translate(hModel, hunter.Position);
-            glm::vec3 faceDir;
-            if (hunter.IsJumping) faceDir = hunter.JumpDirection; else faceDir = glm::normalize(camera.Position - hunter.Position);
-
-            if (glm::length(faceDir) > 0.01f) {
-                float angle = atan2(faceDir.x, faceDir.z);
-                hModel = glm::rotate(hModel, angle, glm::vec3(0, 1, 0));
+            skinBoneOffsetUniform.set(animationSystem.GetPaletteOffset(hunterCharacter));
+            skinBoneCountUniform.set(animationSystem.GetBoneCount(hunterCharacter));
+
+            if (!hunterInPvs) cullStats.occluded++;
+            else if (cullStats.Record(hunterInView)) {
+                gpuProfiler.Begin(hunterSection);
+                skinModelUniform.set(hModel);
+                hunterModel.Draw(skinningShader);
+                gpuProfiler.End(hunterSection);
             }
-            hModel = glm::scale(hModel, glm::vec3(2.5f));
-            skinningShader.setMat4("model", hModel);
-            hunterModel.Draw(skinningShader);
         }
 
         // 7. Render Laser
         if (isShooting) {
+            gpuProfiler.Begin(laserSection);
             laserShader.use();
-            laserShader.setMat4("projection", projection);
-            laserShader.setMat4("view", view);
             glm::mat4 lModel = glm::mat4(1.0f);
             glm::vec3 laserStart = camera.Position + (camera.Front * 0.5f) + (camera.Right * 0.2f) + (camera.Up * -0.2f);
             lModel = glm::translate(lModel, laserStart);
@@ -593,35 +695,65 @@ int main()
             lModel = lModel * glm::toMat4(rot);
             laserShader.setMat4("model", lModel);
             glBindVertexArray(laserVAO); glDrawArrays(GL_LINES, 0, 2);
+            gpuProfiler.End(laserSection);
         }
 
-        // 8. Render Particles
+        // 8. Simulate & Render Particles (one update pass and one draw for all of them)
+        // Unsorted, so they test against the scene depth but do not write it
+        gpuProfiler.Begin(particleSection);
+        UpdateParticles(deltaTime);
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
         glEnable(GL_BLEND);
+        glDepthMask(GL_FALSE);
         particleShader.use();
-        particleShader.setMat4("projection", projection);
-        particleShader.setMat4("view", view);
-        glBindVertexArray(particleVAO);
-        for (const auto& p : particles) {
-            if (p.Life > 0.0f) {
-                glm::mat4 pModel = glm::mat4(1.0f);
-                pModel = glm::translate(pModel, p.Position);
-                pModel[0][0] = view[0][0]; pModel[0][1] = view[1][0]; pModel[0][2] = view[2][0];
-                pModel[1][0] = view[0][1]; pModel[1][1] = view[1][1]; pModel[1][2] = view[2][1];
-                pModel[2][0] = view[0][2]; pModel[2][1] = view[1][2]; pModel[2][2] = view[2][2];
-                pModel = glm::scale(pModel, glm::vec3(0.2f));
-                particleShader.setMat4("model", pModel);
-                particleShader.setVec4("color", p.Color);
-                glDrawArrays(GL_TRIANGLES, 0, 6);
-            }
-        }
+        particleViewportUniform.set((float)framebufferHeight);
+        particles.Draw();
+        glDepthMask(GL_TRUE);
+        gpuProfiler.End(particleSection);
 
         // 9. Render Crosshair
+        gpuProfiler.Begin(crosshairSection);
         RenderCrosshair(crosshairShader, crosshairVAO);
+        gpuProfiler.End(crosshairSection);
+
+        cullSubmittedTotal += cullStats.submitted;
+        cullCulledTotal += cullStats.culled;
+        cullOccludedTotal += cullStats.occluded;
+        cullFrames++;
+        cullReportTimer += deltaTime;
+        if (cullReportTimer >= 5.0f) {
+            // render stats are only printed while F3 is on, along with the GPU profile
+            if (gpuProfiler.IsEnabled()) {
+                std::cout << "RENDER::CULL per frame: " << cullSubmittedTotal / cullFrames << " submitted, "
+                          << cullCulledTotal / cullFrames << " culled, " << cullOccludedTotal / cullFrames << " occluded" << std::endl;
+                const RenderQueue::Stats& queueStats = renderQueue.GetStats();
+                std::cout << "RENDER::QUEUE per frame: " << queueStats.draws / cullFrames << " draws, " << queueStats.programBinds / cullFrames << " program, "
+                          << queueStats.textureBinds / cullFrames << " texture, " << queueStats.vertexArrayBinds / cullFrames << " VAO binds" << std::endl;
+                std::ostringstream profile;
+                profile << "GPU::PROFILE" << std::fixed << std::setprecision(3);
+                for (int section = 0; section < gpuProfiler.SectionCount(); section++)
+                    profile << " " << gpuProfiler.Name(section) << " " << gpuProfiler.AverageMs(section) << " ms,";
+                profile << " total " << gpuProfiler.TotalMs() << " ms";
+                std::cout << profile.str() << std::endl;
+            }
+            renderQueue.ResetStats();
+            cullSubmittedTotal = cullCulledTotal = cullOccludedTotal = cullFrames = 0;
+            cullReportTimer = 0.0f;
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    levelMesh.Release();
+    particles.Release();
+    barrelInstances.Release();
+    gpuProfiler.Release();
+    for (unsigned int texture : { floorTexture, wallTexture, doorTexture, barrelTexture, gunTexture })
+        TextureRegistry::Shared().Release(texture);
+    frameUniforms.Release();
+    bonePalette.Release();
     glfwTerminate();
     return 0;
 }
@@ -641,6 +773,13 @@ void RenderCrosshair(Shader& shader, unsigned int vao) {
     glEnable(GL_DEPTH_TEST);
 }
 
+void LogAnimationCompression(const char* clip, const CompressionReport& report) {
+    std::cout << "ANIMATION::COMPRESS " << clip << ": " << report.bytesBefore << " -> " << report.bytesAfter << " bytes ("
+        << ((long long)report.bytesBefore - (long long)report.bytesAfter) << " saved), keys " << report.keysBefore << " -> " << report.keysAfter
+        << ", " << report.constantTracks << " constant tracks, max error pos " << report.maxPositionError
+        << " rot " << report.maxRotationError << " deg scale " << report.maxScaleError << std::endl;
+}
+
 bool CheckLineOfSight(glm::vec3 start, glm::vec3 end, const std::vector<std::string>& map) {
     glm::vec3 dir = glm::normalize(end - start);
     float dist = glm::distance(start, end);
@@ -657,22 +796,11 @@ bool CheckLineOfSight(glm::vec3 start, glm::vec3 end, const std::vector<std::str
 }
 
 void SpawnParticles(glm::vec3 position) {
-    for (unsigned int i = 0; i < nr_new_particles; ++i) {
-        Particle p;
-        p.Position = position + glm::ballRand(0.5f);
-        p.Color = glm::vec4(1.0f, 0.5f, 0.0f, 1.0f);
-        p.Life = 1.0f;
-        p.Velocity = glm::ballRand(2.0f); p.Velocity.y = std::abs(p.Velocity.y) + 1.0f;
-        particles.push_back(p);
-    }
+    particles.Emit(position, (int)nr_new_particles, barrelBurst);
 }
 
 void UpdateParticles(float dt) {
-    for (auto& p : particles) {
-        p.Life -= dt;
-        if (p.Life > 0.0f) { p.Position += p.Velocity * dt; p.Color.a -= dt * 2.0f; }
-    }
-    particles.erase(std::remove_if(particles.begin(), particles.end(), [](const Particle& p) { return p.Life <= 0.0f; }), particles.end());
+    particles.Update(dt, 2.0f); // Fully faded after half a second
 }
 
 // --- INPUT & LOGIC HANDLER ---
@@ -710,6 +838,9 @@ void processInput(GLFWwindow* window) {
 
             // Reset Map Objects
             barrelVisible.assign(barrelVisible.size(), true);
+            for (size_t i = 0; i < barrelPositions.size(); ++i)
+                barrelGrid.Insert((int)i, barrelPositions[i], barrelRadius);
+            levelVisibility.ResetBarrels();
             destroyedBarrels = 0;
 
             // Reset Weapon
@@ -753,16 +884,14 @@ void processInput(GLFWwindow* window) {
     }
     else { nextPos = camera.Position; }
 
-    // 2. Barrel Collision (Obstacle)
-    for (size_t i = 0; i < barrelPositions.size(); ++i) {
-        if (barrelVisible[i]) {
-            float dist = glm::distance(glm::vec2(nextPos.x, nextPos.z), glm::vec2(barrelPositions[i].x, barrelPositions[i].z));
-            if (dist < 1.0f) {
-                nextPos = camera.Position; // Block movement
-                break;
-            }
-        }
-    }
+    // 2. Barrel Collision (Obstacle), only barrels in the tiles around the player
+    bool blocked = false;
+    barrelGrid.ForEachNear(nextPos, 1.0f, [&](int i) {
+        float dist = glm::distance(glm::vec2(nextPos.x, nextPos.z), glm::vec2(barrelPositions[i].x, barrelPositions[i].z));
+        blocked = dist < 1.0f;
+        return blocked;
+    });
+    if (blocked) nextPos = camera.Position; // Block movement
 
     camera.Position.x = nextPos.x;
     camera.Position.z = nextPos.z;
@@ -775,6 +904,13 @@ void processInput(GLFWwindow* window) {
 }
 
 // --- STANDARD CALLBACKS ---
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+        gpuProfiler.SetEnabled(!gpuProfiler.IsEnabled());
+        std::cout << "GPU::PROFILE " << (gpuProfiler.IsEnabled() ? "enabled" : "disabled") << std::endl;
+    }
+}
+
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
     if (isGameOver || isGameWon) return;
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
@@ -792,29 +928,31 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
                 globalGunAnimator->PlayAnimation(globalGunFireAnim);
             }
 
-            // Raycasting for Shooting
+            // Raycasting for Shooting, candidates come from the tiles along the ray, nearest first
             glm::vec3 rayOrigin = camera.Position;
             glm::vec3 rayDir = glm::normalize(camera.Front);
-            for (size_t i = 0; i < barrelPositions.size(); ++i) {
-                if (barrelVisible[i]) {
-                    glm::vec3 barrelPos = barrelPositions[i];
-                    // Simple Hit Detection
-                    float t = glm::dot(glm::vec2(barrelPos.x, barrelPos.z) - glm::vec2(rayOrigin.x, rayOrigin.z), glm::normalize(glm::vec2(rayDir.x, rayDir.z)));
-                    if (t > 0.0f) {
-                        glm::vec2 closest = glm::vec2(rayOrigin.x, rayOrigin.z) + (glm::normalize(glm::vec2(rayDir.x, rayDir.z)) * t);
-                        if (glm::distance(closest, glm::vec2(barrelPos.x, barrelPos.z)) < barrelRadius) {
-                            // Check Height
-                            float t3D = glm::dot(barrelPos - rayOrigin, rayDir);
-                            glm::vec3 hitPoint = rayOrigin + (rayDir * t3D);
-                            if (hitPoint.y >= 0.0f && hitPoint.y <= 3.0f) {
-                                barrelVisible[i] = false;
-                                destroyedBarrels++;
-                                SpawnParticles(barrelPos + glm::vec3(0, 1.0f, 0));
-                                break;
-                            }
-                        }
-                    }
-                }
+            int hitBarrel = -1;
+            barrelGrid.ForEachAlongRay(rayOrigin, rayDir, [&](int i) {
+                glm::vec3 barrelPos = barrelPositions[i];
+                // Simple Hit Detection
+                float t = glm::dot(glm::vec2(barrelPos.x, barrelPos.z) - glm::vec2(rayOrigin.x, rayOrigin.z), glm::normalize(glm::vec2(rayDir.x, rayDir.z)));
+                if (t <= 0.0f) return false;
+                glm::vec2 closest = glm::vec2(rayOrigin.x, rayOrigin.z) + (glm::normalize(glm::vec2(rayDir.x, rayDir.z)) * t);
+                if (glm::distance(closest, glm::vec2(barrelPos.x, barrelPos.z)) >= barrelRadius) return false;
+                // Check Height
+                float t3D = glm::dot(barrelPos - rayOrigin, rayDir);
+                glm::vec3 hitPoint = rayOrigin + (rayDir * t3D);
+                if (hitPoint.y < 0.0f || hitPoint.y > 3.0f) return false;
+                hitBarrel = i;
+                return true;
+            });
+            if (hitBarrel >= 0) {
+                barrelVisible[hitBarrel] = false;
+                barrelGrid.Remove(hitBarrel);
+                levelVisibility.SetBarrelAlive(hitBarrel, false);
+                barrelInstances.Remove(hitBarrel);
+                destroyedBarrels++;
+                SpawnParticles(barrelPositions[hitBarrel] + glm::vec3(0, 1.0f, 0));
             }
         }
     }
@@ -833,21 +971,5 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) { camera.ProcessMouseScroll(static_cast<float>(yoffset)); }
 
-unsigned int loadTexture(char const* path) {
-    unsigned int textureID; glGenTextures(1, &textureID);
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data) {
-        GLenum format = (nrComponents == 1) ? GL_RED : (nrComponents == 3 ? GL_RGB : GL_RGBA);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        stbi_image_free(data);
-    }
-    else { std::cout << "Texture failed to load at path: " << path << std::endl; stbi_image_free(data); }
-    return textureID;
-}
+// textures with alpha are clamped so their transparent borders do not bleed
+GLint TextureWrapFor(const DecodedImage& image) { return image.Format() == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT; }
@@ -1,9 +1,19 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
+// Per-frame block, must match FrameData in frame_uniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
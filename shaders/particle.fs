@@ -1,14 +1,13 @@
 #version 330 core
+in vec4 ParticleColor;
 out vec4 FragColor;
 
-uniform vec4 color;
-
 void main()
 {
     float dist = length(gl_PointCoord - vec2(0.5));
     if (dist > 0.5) {
         discard;
     }
-    FragColor = color;
+    FragColor = ParticleColor;
     FragColor.a *= (1.0 - (dist / 0.5)); // Fade out at the edges
 }
\ No newline at end of file
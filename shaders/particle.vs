@@ -1,12 +1,35 @@
 #version 330 core
-layout (location = 0) in float aDummy; // We don't use vertex attributes
+layout (location = 0) in vec4 aPositionLife; // xyz position, w remaining life in seconds
+layout (location = 2) in vec4 aColor;
 
-uniform vec3 offset;
-uniform mat4 projection;
-uniform mat4 view;
+out vec4 ParticleColor;
+
+// Per-frame block, must match FrameData in frame_uniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
+uniform float particleSize;   // world units
+uniform float viewportHeight; // pixels
 
 void main()
 {
-    gl_Position = projection * view * vec4(offset, 1.0);
-    gl_PointSize = 10.0; // Size of the particle
+    ParticleColor = aColor;
+    if (aPositionLife.w <= 0.0)
+    {
+        // dead slot, outside the clip volume
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 1.0;
+        return;
+    }
+    gl_Position = projection * view * vec4(aPositionLife.xyz, 1.0);
+    // point sprites are sized in pixels, scale with distance like a billboard would
+    gl_PointSize = particleSize * 0.5 * viewportHeight * projection[1][1] / gl_Position.w;
 }
\ No newline at end of file
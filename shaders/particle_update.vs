@@ -0,0 +1,80 @@
+#version 330 core
+// Transform feedback pass: one point per particle slot, the outputs are written to the other buffer
+layout (location = 0) in vec4 aPositionLife; // xyz position, w remaining life in seconds
+layout (location = 1) in vec4 aVelocity;
+layout (location = 2) in vec4 aColor;
+
+out vec4 PositionLife;
+out vec4 Velocity;
+out vec4 Color;
+
+// must match GpuParticles::MAX_EMITS
+const int MAX_EMITS = 16;
+
+uniform int capacity;
+uniform float deltaTime;
+uniform float fadeRate;
+
+// bursts emitted since the last update, each covering count slots from first (wrapping)
+uniform int emitTotal;
+uniform int emitFirst[MAX_EMITS];
+uniform int emitCount[MAX_EMITS];
+uniform int emitSeed[MAX_EMITS];
+uniform vec3 emitCenter[MAX_EMITS];
+uniform vec4 emitMotion[MAX_EMITS]; // spread, speed, lift, life
+uniform vec4 emitColor[MAX_EMITS];
+
+uint hash(uint x)
+{
+    x ^= x >> 16u; x *= 0x7feb352du;
+    x ^= x >> 15u; x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return x;
+}
+
+// uniform in [0, 1)
+float random(inout uint state)
+{
+    state = hash(state);
+    return float(state >> 8u) / 16777216.0;
+}
+
+// uniform inside a ball of the given radius
+vec3 inBall(inout uint state, float radius)
+{
+    float z = random(state) * 2.0 - 1.0;
+    float angle = random(state) * 6.2831853;
+    float r = sqrt(1.0 - z * z);
+    return vec3(r * cos(angle), r * sin(angle), z) * radius * pow(random(state), 1.0 / 3.0);
+}
+
+void main()
+{
+    PositionLife = aPositionLife;
+    Velocity = aVelocity;
+    Color = aColor;
+
+    for (int e = 0; e < emitTotal; e++)
+    {
+        int k = (gl_VertexID - emitFirst[e] + capacity) % capacity;
+        if (k < emitCount[e])
+        {
+            uint state = hash(uint(gl_VertexID) ^ hash(uint(emitSeed[e])));
+            vec4 motion = emitMotion[e];
+            vec3 velocity = inBall(state, motion.y);
+            velocity.y = abs(velocity.y) + motion.z;
+            PositionLife = vec4(emitCenter[e] + inBall(state, motion.x), motion.w);
+            Velocity = vec4(velocity, 0.0);
+            Color = emitColor[e];
+            return;
+        }
+    }
+
+    if (PositionLife.w <= 0.0) return;
+    PositionLife.w -= deltaTime;
+    if (PositionLife.w > 0.0)
+    {
+        PositionLife.xyz += Velocity.xyz * deltaTime;
+        Color.a -= deltaTime * fadeRate;
+    }
+}
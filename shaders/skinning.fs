@@ -5,12 +5,17 @@ in vec2 TexCoords;
 in vec3 Normal;
 in vec3 FragPos;
 
-struct Light {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
+// Per-frame block, must match FrameData in frame_uniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
 };
-uniform Light light;
 
 uniform sampler2D texture_diffuse1; 
 
@@ -19,12 +24,12 @@ void main()
     vec4 texColor = texture(texture_diffuse1, TexCoords);
     if(texColor.a < 0.1) discard; 
     
-    vec3 ambient = light.ambient * texColor.rgb;
+    vec3 ambient = lightAmbient.rgb * texColor.rgb;
     
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(-light.direction); 
+    vec3 lightDir = normalize(-lightDirection.xyz); 
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * texColor.rgb;
+    vec3 diffuse = lightDiffuse.rgb * diff * texColor.rgb;
     
     FragColor = vec4(ambient + diffuse, 1.0);
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
 #version 330 core
+// Fed either by Vertex (mesh.h) or by a packed PackedMesh layout: normals/tangents arrive as
+// normalized 10:10:10:2, texcoords as half floats, bone ids as int8/int16 and weights as unorm8,
+// all converted by the vertex fetch so the declarations are the same for both.
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
@@ -7,12 +10,34 @@ layout (location = 4) in vec4 aBitangent;
 layout (location = 5) in ivec4 boneIds; 
 layout (location = 6) in vec4 weights;
 
-uniform mat4 projection;
-uniform mat4 view;
+// Per-frame block, must match FrameData in frame_uniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
 uniform mat4 model;
 
-const int MAX_BONES = 200; 
-uniform mat4 finalBonesMatrices[MAX_BONES];
+// Skinning matrices of every character this frame (see bone_palette.h), 4 texels per matrix.
+// boneOffset selects this draw's palette, boneCount is the skeleton's bone count.
+uniform samplerBuffer bonePalette;
+uniform int boneOffset;
+uniform int boneCount;
+
+mat4 boneMatrix(int id)
+{
+    int base = (boneOffset + id) * 4;
+    return mat4(texelFetch(bonePalette, base),
+                texelFetch(bonePalette, base + 1),
+                texelFetch(bonePalette, base + 2),
+                texelFetch(bonePalette, base + 3));
+}
 
 out vec2 TexCoords;
 out vec3 Normal;
@@ -28,7 +53,7 @@ void main()
     for(int i = 0 ; i < 4 ; i++) 
     {
         // 1. ตัดกระดูกเสีย (-1) และกระดูกเกินทิ้ง
-        if(boneIds[i] < 0 || boneIds[i] >= MAX_BONES) 
+        if(boneIds[i] < 0 || boneIds[i] >= boneCount) 
         {
             continue; 
         }
@@ -40,10 +65,11 @@ void main()
         }
 
         // คำนวณปกติ
-        vec4 localPosition = finalBonesMatrices[boneIds[i]] * vec4(aPos,1.0f);
+        mat4 bone = boneMatrix(boneIds[i]);
+        vec4 localPosition = bone * vec4(aPos,1.0f);
         totalPosition += localPosition * weights[i];
         
-        vec3 localNormal = mat3(finalBonesMatrices[boneIds[i]]) * aNormal;
+        vec3 localNormal = mat3(bone) * aNormal;
         totalNormal += localNormal * weights[i];
 
         totalWeight += weights[i]; // สะสมน้ำหนัก
@@ -6,16 +6,18 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
 
-struct DirLight {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
+// Per-frame block, must match FrameData in frame_uniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
 };
 
-uniform DirLight light;
-uniform vec3 viewPos;
 uniform sampler2D texture_diffuse1;
 
 void main() {
@@ -36,18 +38,18 @@ void main() {
     vec3 norm = normalize(Normal);
 
     // 2. FLASHLIGHT (High Power / Long Range)
-    vec3 lightDir = normalize(viewPos - FragPos);
+    vec3 lightDir = normalize(viewPos.xyz - FragPos);
 
     // Diffuse
     float diff = max(dot(norm, lightDir), 0.0);
 
     // Specular
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 64.0);
 
     // Attenuation Logic
-    float distance = length(viewPos - FragPos);
+    float distance = length(viewPos.xyz - FragPos);
 
     // Low attenuation for long range flashlight (Map Scale x10 friendly)
     float attenuation = 1.0 / (1.0 + 0.007 * distance + 0.0002 * distance * distance);
@@ -56,7 +58,7 @@ void main() {
     vec3 flashlight = (diff * flashlightColor + spec * flashlightColor) * attenuation * 2.5;
 
     // 3. AMBIENT LIGHT
-    vec3 ambient = light.ambient * sciFiAmbientColor;
+    vec3 ambient = lightAmbient.rgb * sciFiAmbientColor;
     vec3 finalLight = ambient + flashlight;
     vec3 result = finalLight * objectColor;
     FragColor = vec4(result, 1.0);
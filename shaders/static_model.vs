@@ -1,16 +1,26 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoords;
+layout (location = 1) in vec3 aNormal;    // float, or packed snorm 10:10:10:2 (PackedMesh)
+layout (location = 2) in vec2 aTexCoords; // float, or half float (PackedMesh)
 
 // Outputs to Fragment Shader
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
+// Per-frame block, must match FrameData in frame_uniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
@@ -0,0 +1,32 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;    // float, or packed snorm 10:10:10:2 (PackedMesh)
+layout (location = 2) in vec2 aTexCoords; // float, or half float (PackedMesh)
+layout (location = 7) in mat4 aInstanceModel; // per instance, locations 7-10 (InstanceBuffer)
+
+// Outputs to Fragment Shader
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+// Per-frame block, must match FrameData in frame_uniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
+void main()
+{
+    mat4 model = aInstanceModel;
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoords = aTexCoords;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}